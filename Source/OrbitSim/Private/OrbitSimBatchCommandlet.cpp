@@ -0,0 +1,478 @@
+// DHmelevcev 2025
+
+#include "OrbitSimBatchCommandlet.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/JsonSerializer.h"
+#include "SimAccessWindows.h"
+#include "SimCoverage.h"
+#include "SimCoverageCube.h"
+#include "SimDenseOutput.h"
+#include "SimEngine.h"
+#include "SimFileManager.h"
+
+namespace
+{
+	// options followed by their value when it is not given with =
+	const TCHAR* const ValueOptions[] = { TEXT("until"), TEXT("from"), TEXT("out"), TEXT("sample"),
+	                                      TEXT("grid"), TEXT("resolution"), TEXT("folds"),
+	                                      TEXT("cube"), TEXT("access") };
+
+	// duration after Start like 30d, 12h, 90m, 3600s or 3600, or ISO 8601 time
+	bool ParseTime
+	(
+		const FString& Text,
+		const FDateTime& Start,
+		FDateTime& OutTime
+	)
+	{
+		FString Number = Text;
+		double Scale = 1;
+
+		if (Number.RemoveFromEnd(TEXT("d")))
+			Scale = 86400;
+		else if (Number.RemoveFromEnd(TEXT("h")))
+			Scale = 3600;
+		else if (Number.RemoveFromEnd(TEXT("m")))
+			Scale = 60;
+		else
+			Number.RemoveFromEnd(TEXT("s"));
+
+		if (!Number.IsEmpty() && Number.IsNumeric())
+		{
+			OutTime = Start + FTimespan::FromSeconds(FCString::Atod(*Number) * Scale);
+			return true;
+		}
+
+		return FDateTime::ParseIso8601(*Text, OutTime);
+	}
+
+	TArray<TSharedPtr<FJsonValue>> VectorToJson
+	(
+		const FVector& Vector
+	)
+	{
+		return {
+			MakeShared<FJsonValueNumber>(Vector.X),
+			MakeShared<FJsonValueNumber>(Vector.Y),
+			MakeShared<FJsonValueNumber>(Vector.Z)
+		};
+	}
+}
+
+UOrbitSimBatchCommandlet::UOrbitSimBatchCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UOrbitSimBatchCommandlet::Main
+(
+	const FString& Params
+)
+{
+	FString ScenarioFile;
+	TMap<FString, FString> Options;
+
+	// options are -name=value, --name=value or --name value
+	const TCHAR* Stream = *Params;
+	FString Token;
+
+	while (FParse::Token(Stream, Token, false))
+	{
+		if (!Token.StartsWith(TEXT("-")))
+		{
+			if (ScenarioFile.IsEmpty() && FPaths::GetExtension(Token) == TEXT("json"))
+				ScenarioFile = Token;
+
+			continue;
+		}
+
+		Token.RightChopInline(Token.StartsWith(TEXT("--")) ? 2 : 1);
+
+		FString Name = Token;
+		FString Value;
+
+		if (!Token.Split(TEXT("="), &Name, &Value))
+		{
+			const TCHAR* Next = Stream;
+			FString NextToken;
+
+			for (const TCHAR* Option : ValueOptions)
+			{
+				if (Name == Option && FParse::Token(Next, NextToken, false) && !NextToken.StartsWith(TEXT("-")))
+				{
+					Value = NextToken;
+					Stream = Next;
+					break;
+				}
+			}
+		}
+
+		Options.Add(Name, Value);
+	}
+
+	if (ScenarioFile.IsEmpty() || !Options.Contains(TEXT("until")))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=OrbitSimBatch scenario.json --until=<time | duration> "
+		                            "[--from=<time>] [--out=<file.json>] [--coverage] [--sample=<s>] "
+		                            "[--grid=latlon | equalarea] [--resolution=<deg.>] [--folds=<k,k,...>] "
+		                            "[--cube=<file.cube>] [--access=<file.csv>]"));
+		return 1;
+	}
+
+	if (FPaths::IsRelative(ScenarioFile))
+		ScenarioFile = FPaths::Combine(FPaths::LaunchDir(), ScenarioFile);
+
+	FSimEngine Engine;
+	FSimScenario Scenario;
+
+	if (!USimFileManager::ReadScenario(ScenarioFile, Scenario, Engine.Settings))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Can not read scenario %s"), *ScenarioFile);
+		return 1;
+	}
+
+	// the same start as a level without WorldTime set
+	if (const FString* From = Options.Find(TEXT("from")))
+	{
+		if (!FDateTime::ParseIso8601(**From, Engine.UpdatedTo))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Wrong start time %s"), **From);
+			return 1;
+		}
+	}
+
+	const FDateTime Start = Engine.UpdatedTo;
+	FDateTime Until;
+
+	if (!ParseTime(Options[TEXT("until")], Start, Until))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Wrong end time %s"), *Options[TEXT("until")]);
+		return 1;
+	}
+
+	if (!Scenario.Ephemeris.IsEmpty() && !USimFileManager::LoadEphemeris(Engine.Ephemeris, Scenario.Ephemeris))
+		UE_LOG(LogTemp, Warning, TEXT("Can not load ephemeris %s"), *Scenario.Ephemeris);
+
+	if (Scenario.CelestialBodies.IsEmpty())
+	{
+		FSimScenarioBody& Earth = Scenario.CelestialBodies.Emplace_GetRef();
+
+		Earth.Name = TEXT("Earth");
+		Earth.GM = GM_Earth;
+		Earth.J2 = J2_Earth;
+		Earth.Radius = R_Earth;
+		Earth.SiderealRotationPeriod = SRP_Earth;
+	}
+
+	TArray<FString> CelestialNames;
+	for (const auto& Body : Scenario.CelestialBodies)
+		CelestialNames.Emplace(Body.Name);
+
+	// analytic satellites go last, as ASimGameMode orders them
+	const bool FullyAnalytic = Engine.Settings.Propagation == ESimPropagation::Analytic;
+
+	TArray<const FSimScenarioSatellite*> Satellites;
+	TArray<const FSimScenarioSatellite*> AnalyticSatellites;
+
+	for (const auto& Satellite : Scenario.Satellites)
+	{
+		if (!CelestialNames.Contains(Satellite.Body))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Satellite %s orbits unknown body %s"), *Satellite.Name, *Satellite.Body);
+			continue;
+		}
+
+		const bool Analytic = FullyAnalytic ||
+		                      Satellite.Propagation.Get(ESimPropagation::Numeric) == ESimPropagation::Analytic;
+
+		(Analytic ? AnalyticSatellites : Satellites).Emplace(&Satellite);
+	}
+
+	const int32 NumC = CelestialNames.Num();
+	const int32 NumNumeric = Satellites.Num();
+	Satellites.Append(AnalyticSatellites);
+
+	FSimStateStore& State = Engine.State;
+
+	// celestial bodies relative to the first one
+	const FSimScenarioBody& Origin = Scenario.CelestialBodies[0];
+
+	State.SetNum(NumC, 0);
+
+	for (int32 i = 0; i < NumC; ++i)
+	{
+		const FSimScenarioBody& Body = Scenario.CelestialBodies[i];
+
+		State.Position.Set(i, Body.Position - Origin.Position);
+		State.Velocity.Set(i, Body.Velocity - Origin.Velocity);
+
+		State.GM[i] = Body.GM;
+		State.J2[i] = Body.J2;
+		State.Radius[i] = Body.Radius;
+		State.RotationPeriod[i] = Body.SiderealRotationPeriod;
+	}
+
+	// moves celestial bodies to the ephemeris, satellites are placed around
+	// them there, growing the store keeps the celestial part
+	Engine.Reset(CelestialNames);
+
+	State.SetNum(NumC, NumNumeric, Satellites.Num() - NumNumeric);
+
+	for (int32 i = 0; i < Satellites.Num(); ++i)
+	{
+		const FSimScenarioSatellite& Satellite = *Satellites[i];
+		const int32 Body = CelestialNames.Find(Satellite.Body);
+
+		FVector Position, Velocity;
+		FSimEngine::OrbitToState(State.GM[Body],
+		                         Satellite.SemiMajorAxis, Satellite.Eccentricity, Satellite.Inclination,
+		                         Satellite.LongitudeOfAscendingNode, Satellite.ArgumentOfPerigee, Satellite.TrueAnomaly,
+		                         Position, Velocity);
+
+		State.Position.Set(NumC + i, State.Position.Get(Body) + Position);
+		State.Velocity.Set(NumC + i, State.Velocity.Get(Body) + Velocity);
+	}
+
+	Engine.Reset(CelestialNames);
+
+	UE_LOG(LogTemp, Display, TEXT("%s: %d celestial bodies, %d satellites from %s to %s"),
+	       *FPaths::GetCleanFilename(ScenarioFile), NumC, Satellites.Num(),
+	       *Start.ToIso8601(), *Until.ToIso8601());
+
+	// contacts are planned from the initial state without stepping
+	if (const FString* AccessFile = Options.Find(TEXT("access")))
+	{
+		TArray<FSimAccessStation> Stations;
+		TArray<FString> StationNames;
+
+		for (const auto& Station : Scenario.Stations)
+		{
+			const int32 Body = CelestialNames.Find(Station.Body);
+
+			if (Body == INDEX_NONE)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Station %s stands on unknown body %s"), *Station.Name, *Station.Body);
+				continue;
+			}
+
+			FSimAccessStation& AccessStation = Stations.Emplace_GetRef();
+
+			AccessStation.Body = Body;
+			AccessStation.Latitude = Station.Latitude;
+			AccessStation.Longitude = Station.Longitude;
+
+			StationNames.Emplace(Station.Name);
+		}
+
+		TArray<FString> SatelliteNames;
+		for (const auto* Satellite : Satellites)
+			SatelliteNames.Emplace(Satellite->Name);
+
+		if (Until < Start)
+			UE_LOG(LogTemp, Warning, TEXT("Access windows are planned forward only"));
+
+		const double AccessStart = FPlatformTime::Seconds();
+
+		FSimAccessPlanner Planner;
+		Planner.Reset(State, Start, Stations);
+
+		TArray<FSimAccessWindow> Windows;
+		Planner.Compute((Until - Start).GetTotalSeconds(), Windows);
+
+		UE_LOG(LogTemp, Display, TEXT("%d access windows of %d stations in %.3f s"),
+		       Windows.Num(), Stations.Num(), FPlatformTime::Seconds() - AccessStart);
+
+		if (!USimFileManager::SaveAccessWindows(Windows, Start, StationNames, SatelliteNames, *AccessFile))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Can not write %s"), **AccessFile);
+			return 1;
+		}
+	}
+
+	const int32 Direction = FMath::Sign((Until - Start).GetTicks());
+
+	// the engine takes whole dt steps and stops on the last one that does
+	// not pass Until, which is Until itself only when Until - Start is a
+	// multiple of dt, the time reached goes with final states
+	const FDateTime Target = Direction > 0 ? Until + FTimespan(1) : Until + FSimEngine::dt - FTimespan(1);
+
+	// the same sampling as ASimGameMode::StartLog
+	const bool bCoverage = Options.Contains(TEXT("coverage"));
+	double SampleInterval = 30;
+
+	if (const FString* Sample = Options.Find(TEXT("sample")))
+		SampleInterval = FMath::Max(FCString::Atod(**Sample), 0.001);
+
+	// samples at exact epochs from Start, between steps as well
+	const int32 SampleDirection = Direction != 0 ? Direction : 1;
+	const FTimespan SampleStep = FTimespan::FromSeconds(SampleDirection * SampleInterval);
+
+	ESimCoverageGrid Grid = ESimCoverageGrid::LatitudeLongitude;
+	double Resolution = 1;
+
+	if (const FString* GridName = Options.Find(TEXT("grid")))
+	{
+		if (*GridName == TEXT("equalarea"))
+			Grid = ESimCoverageGrid::EqualArea;
+		else if (*GridName != TEXT("latlon"))
+			UE_LOG(LogTemp, Warning, TEXT("Unknown coverage grid %s, using latlon"), **GridName);
+	}
+
+	if (const FString* ResolutionValue = Options.Find(TEXT("resolution")))
+		Resolution = FCString::Atod(**ResolutionValue);
+
+	TArray<int32> Folds = { 1, 2, 4 };
+
+	if (const FString* FoldList = Options.Find(TEXT("folds")))
+	{
+		TArray<FString> FoldValues;
+		FoldList->ParseIntoArray(FoldValues, TEXT(","));
+
+		Folds.Reset();
+		for (const auto& Fold : FoldValues)
+			Folds.Emplace(FCString::Atoi(*Fold));
+	}
+
+	// cells are only allocated for a coverage run
+	FSimCoverage Coverage(Grid, bCoverage ? Resolution : 180, Folds);
+	FSimCoverageCubeWriter Cube;
+
+	if (const FString* CubeFile = Options.Find(TEXT("cube")))
+	{
+		if (bCoverage && !Cube.Open(*CubeFile, Coverage))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Can not write %s"), **CubeFile);
+			return 1;
+		}
+	}
+
+	FSimDenseOutput Dense;
+	TArray<FVector> Positions;
+	FDateTime NextSample = Start;
+
+	// every epoch up to the engine time
+	auto SampleCoverage = [&]()
+	{
+		while (SampleDirection * (Engine.UpdatedTo - NextSample).GetTicks() >= 0)
+		{
+			// skips stop short of a sample, the step that reaches it is interpolated
+			verify(Dense.GetPositions(Engine, NextSample, Positions));
+			Coverage.Accumulate(NextSample, Positions, State.Radius[0], Engine.GetRotation(0, NextSample),
+			                    Cube.AddSample(NextSample));
+
+			NextSample += SampleStep;
+		}
+	};
+
+	if (bCoverage)
+		SampleCoverage();
+
+	const double Span = FMath::Abs((Until - Start).GetTotalSeconds());
+	const double WallStart = FPlatformTime::Seconds();
+
+	int64 Steps = 0;
+	int32 Reported = 0;
+
+	while (Engine.IsAhead(Target, Direction))
+	{
+		// analytic bodies skip up to the step of the next sample
+		const bool SampleFirst = bCoverage && Direction * (Target - NextSample).GetTicks() > 0;
+		const int64 Skipped = Engine.Skip(SampleFirst ? NextSample : Target, Direction);
+
+		if (Skipped > 0)
+		{
+			Steps += Skipped;
+		}
+		else
+		{
+			Dense.BeginStep(Engine);
+			Engine.Step(Direction);
+			Dense.EndStep(Engine);
+
+			++Steps;
+		}
+
+		if (bCoverage)
+			SampleCoverage();
+
+		// progress every tenth of the span
+		const int32 Done = FMath::FloorToInt32(10 * FMath::Abs((Engine.UpdatedTo - Start).GetTotalSeconds()) / Span);
+
+		if (Done > Reported)
+		{
+			Reported = Done;
+			UE_LOG(LogTemp, Display, TEXT("%3d%% %s"), 10 * FMath::Min(Done, 10), *Engine.UpdatedTo.ToIso8601());
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("%lld steps to %s in %.3f s"),
+	       Steps, *Engine.UpdatedTo.ToIso8601(), FPlatformTime::Seconds() - WallStart);
+
+	if (Engine.UpdatedTo != Until)
+		UE_LOG(LogTemp, Warning, TEXT("Stopped %.3f s short of %s, the span is not a multiple of %.0f s steps"),
+		       FMath::Abs((Until - Engine.UpdatedTo).GetTotalSeconds()), *Until.ToIso8601(), FSimEngine::dtSeconds);
+
+	// final states relative to the origin
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+
+	Json->SetStringField("Time", Engine.UpdatedTo.ToIso8601());
+	Json->SetNumberField("Steps", Steps);
+
+	TArray<TSharedPtr<FJsonValue>> Bodies;
+
+	auto AddBody = [&](const FString& Name, int32 Index)
+	{
+		TSharedRef<FJsonObject> Body = MakeShared<FJsonObject>();
+
+		Body->SetStringField("Name", Name);
+		Body->SetArrayField("Position", VectorToJson(State.Position.Get(Index)));
+		Body->SetArrayField("Velocity", VectorToJson(State.Velocity.Get(Index)));
+
+		Bodies.Emplace(MakeShared<FJsonValueObject>(Body));
+	};
+
+	for (int32 i = 0; i < NumC; ++i)
+		AddBody(CelestialNames[i], i);
+
+	for (int32 i = 0; i < Satellites.Num(); ++i)
+		AddBody(Satellites[i]->Name, NumC + i);
+
+	Json->SetArrayField("Bodies", Bodies);
+
+	FString OutFile = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OrbitSimBatch.json"));
+
+	if (const FString* Out = Options.Find(TEXT("out")))
+		OutFile = *Out;
+
+	FString JsonString;
+
+	if (!FJsonSerializer::Serialize(Json, TJsonWriterFactory<>::Create(&JsonString)) ||
+		!FFileHelper::SaveStringToFile(JsonString, *OutFile))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Can not write %s"), *OutFile);
+		return 1;
+	}
+
+	if (bCoverage)
+	{
+		int32 Width, Height;
+		const TArray<double> Image = Coverage.Render(Coverage.GetAverage(), Width, Height);
+
+		if (Cube.IsOpen() && !Cube.Close())
+			UE_LOG(LogTemp, Error, TEXT("Can not write %s"), *Options[TEXT("cube")]);
+
+		USimFileManager::SaveCoverageData(Image, Width, Height,
+		                                  FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("log.bmp")));
+
+		const FString StatisticsFile = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OrbitSimBatchCoverage.csv"));
+
+		if (!USimFileManager::SaveCoverageStatistics(Coverage, StatisticsFile))
+			UE_LOG(LogTemp, Error, TEXT("Can not write %s"), *StatisticsFile);
+	}
+
+	return 0;
+}
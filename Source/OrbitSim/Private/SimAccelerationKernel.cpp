@@ -0,0 +1,219 @@
+// DHmelevcev 2025
+
+#include "SimAccelerationKernel.h"
+#include "SimCpuFeatures.h"
+
+using FKernelFunction = void (*)(const FSimAttractor&,
+                                 const double*, const double*, const double*,
+                                 double*, double*, double*,
+                                 int32, int32);
+
+FSimAttractor FSimAccelerationKernel::MakeAttractor
+(
+	double X,
+	double Y,
+	double Z,
+	double GM,
+	double J2,
+	double Radius
+)
+{
+	FSimAttractor Attractor;
+	Attractor.X = X;
+	Attractor.Y = Y;
+	Attractor.Z = Z;
+	Attractor.GM = GM;
+	Attractor.J2Factor = 1.5e6 * J2 * GM * Radius * Radius;
+	return Attractor;
+}
+
+void FSimAccelerationKernel::AccumulateScalar
+(
+	const FSimAttractor& Attractor,
+	const double* PX, const double* PY, const double* PZ,
+	double* AX, double* AY, double* AZ,
+	int32 Begin,
+	int32 End
+)
+{
+	const double GM = Attractor.GM;
+
+	// radius vector between bodies
+	double rx, ry, rz;
+	// distance between bodies
+	double norm_r;
+	// distance square
+	double r2;
+	// z component of radius vector squared
+	double z2;
+	// J2 acceleration factor
+	double k;
+
+	for (int32 p = Begin; p < End; ++p)
+	{
+		rx = Attractor.X - PX[p];
+		ry = Attractor.Y - PY[p];
+		rz = Attractor.Z - PZ[p];
+		r2 = rx * rx + ry * ry + rz * rz;
+		norm_r = FMath::Sqrt(r2);
+
+		AX[p] += rx * GM / (norm_r * r2);
+		AY[p] += ry * GM / (norm_r * r2);
+		AZ[p] += rz * GM / (norm_r * r2);
+
+		if (Attractor.J2Factor == 0)
+			continue;
+
+		z2 = rz * rz;
+		k = Attractor.J2Factor / (r2 * r2);
+
+		// direction of J2 pertuberation acceleration
+		AX[p] -= rx / norm_r * (5 * z2 / r2 - 1) * k;
+		AY[p] -= ry / norm_r * (5 * z2 / r2 - 1) * k;
+		AZ[p] -= rz / norm_r * (5 * z2 / r2 - 3) * k;
+	}
+}
+
+#if PLATFORM_CPU_X86_FAMILY
+
+// One sqrt and one divide per body, J2 term is evaluated unconditionally:
+// a = r * (GM / |r|^3 - J2Factor / |r|^5 * (5 z^2 / |r|^2 - 1)),
+// with -3 instead of -1 for the z component.
+SIM_TARGET_AVX2 static void AccumulateAVX2
+(
+	const FSimAttractor& Attractor,
+	const double* PX, const double* PY, const double* PZ,
+	double* AX, double* AY, double* AZ,
+	int32 Begin,
+	int32 End
+)
+{
+	const __m256d cx = _mm256_set1_pd(Attractor.X);
+	const __m256d cy = _mm256_set1_pd(Attractor.Y);
+	const __m256d cz = _mm256_set1_pd(Attractor.Z);
+	const __m256d gm = _mm256_set1_pd(Attractor.GM);
+	const __m256d j2 = _mm256_set1_pd(Attractor.J2Factor);
+	const __m256d one = _mm256_set1_pd(1.);
+	const __m256d two = _mm256_set1_pd(2.);
+	const __m256d five = _mm256_set1_pd(5.);
+
+	int32 p = Begin;
+	for (; p + 4 <= End; p += 4)
+	{
+		const __m256d rx = _mm256_sub_pd(cx, _mm256_loadu_pd(PX + p));
+		const __m256d ry = _mm256_sub_pd(cy, _mm256_loadu_pd(PY + p));
+		const __m256d rz = _mm256_sub_pd(cz, _mm256_loadu_pd(PZ + p));
+
+		const __m256d r2 = _mm256_fmadd_pd(rz, rz, _mm256_fmadd_pd(ry, ry, _mm256_mul_pd(rx, rx)));
+		const __m256d inv_r = _mm256_div_pd(one, _mm256_sqrt_pd(r2));
+		const __m256d inv_r2 = _mm256_mul_pd(inv_r, inv_r);
+		const __m256d inv_r3 = _mm256_mul_pd(inv_r2, inv_r);
+
+		const __m256d point_mass = _mm256_mul_pd(gm, inv_r3);
+		const __m256d k = _mm256_mul_pd(j2, _mm256_mul_pd(inv_r3, inv_r2));
+		const __m256d f1 = _mm256_fmsub_pd(_mm256_mul_pd(five, _mm256_mul_pd(rz, rz)), inv_r2, one);
+		const __m256d f3 = _mm256_sub_pd(f1, two);
+
+		const __m256d sxy = _mm256_fnmadd_pd(k, f1, point_mass);
+		const __m256d sz = _mm256_fnmadd_pd(k, f3, point_mass);
+
+		_mm256_storeu_pd(AX + p, _mm256_fmadd_pd(rx, sxy, _mm256_loadu_pd(AX + p)));
+		_mm256_storeu_pd(AY + p, _mm256_fmadd_pd(ry, sxy, _mm256_loadu_pd(AY + p)));
+		_mm256_storeu_pd(AZ + p, _mm256_fmadd_pd(rz, sz, _mm256_loadu_pd(AZ + p)));
+	}
+
+	FSimAccelerationKernel::AccumulateScalar(Attractor, PX, PY, PZ, AX, AY, AZ, p, End);
+}
+
+SIM_TARGET_AVX512 static void AccumulateAVX512
+(
+	const FSimAttractor& Attractor,
+	const double* PX, const double* PY, const double* PZ,
+	double* AX, double* AY, double* AZ,
+	int32 Begin,
+	int32 End
+)
+{
+	const __m512d cx = _mm512_set1_pd(Attractor.X);
+	const __m512d cy = _mm512_set1_pd(Attractor.Y);
+	const __m512d cz = _mm512_set1_pd(Attractor.Z);
+	const __m512d gm = _mm512_set1_pd(Attractor.GM);
+	const __m512d j2 = _mm512_set1_pd(Attractor.J2Factor);
+	const __m512d one = _mm512_set1_pd(1.);
+	const __m512d two = _mm512_set1_pd(2.);
+	const __m512d five = _mm512_set1_pd(5.);
+
+	int32 p = Begin;
+	for (; p + 8 <= End; p += 8)
+	{
+		const __m512d rx = _mm512_sub_pd(cx, _mm512_loadu_pd(PX + p));
+		const __m512d ry = _mm512_sub_pd(cy, _mm512_loadu_pd(PY + p));
+		const __m512d rz = _mm512_sub_pd(cz, _mm512_loadu_pd(PZ + p));
+
+		const __m512d r2 = _mm512_fmadd_pd(rz, rz, _mm512_fmadd_pd(ry, ry, _mm512_mul_pd(rx, rx)));
+		const __m512d inv_r = _mm512_div_pd(one, _mm512_sqrt_pd(r2));
+		const __m512d inv_r2 = _mm512_mul_pd(inv_r, inv_r);
+		const __m512d inv_r3 = _mm512_mul_pd(inv_r2, inv_r);
+
+		const __m512d point_mass = _mm512_mul_pd(gm, inv_r3);
+		const __m512d k = _mm512_mul_pd(j2, _mm512_mul_pd(inv_r3, inv_r2));
+		const __m512d f1 = _mm512_fmsub_pd(_mm512_mul_pd(five, _mm512_mul_pd(rz, rz)), inv_r2, one);
+		const __m512d f3 = _mm512_sub_pd(f1, two);
+
+		const __m512d sxy = _mm512_fnmadd_pd(k, f1, point_mass);
+		const __m512d sz = _mm512_fnmadd_pd(k, f3, point_mass);
+
+		_mm512_storeu_pd(AX + p, _mm512_fmadd_pd(rx, sxy, _mm512_loadu_pd(AX + p)));
+		_mm512_storeu_pd(AY + p, _mm512_fmadd_pd(ry, sxy, _mm512_loadu_pd(AY + p)));
+		_mm512_storeu_pd(AZ + p, _mm512_fmadd_pd(rz, sz, _mm512_loadu_pd(AZ + p)));
+	}
+
+	AccumulateAVX2(Attractor, PX, PY, PZ, AX, AY, AZ, p, End);
+}
+
+#endif // PLATFORM_CPU_X86_FAMILY
+
+struct FKernelDispatch
+{
+	FKernelFunction Function = &FSimAccelerationKernel::AccumulateScalar;
+	const TCHAR* InstructionSet = TEXT("Scalar");
+
+	FKernelDispatch()
+	{
+#if PLATFORM_CPU_X86_FAMILY
+		if (HasAVX512())
+		{
+			Function = &AccumulateAVX512;
+			InstructionSet = TEXT("AVX-512");
+		}
+		else if (HasAVX2())
+		{
+			Function = &AccumulateAVX2;
+			InstructionSet = TEXT("AVX2");
+		}
+#endif
+	}
+};
+
+static const FKernelDispatch& GetDispatch()
+{
+	static const FKernelDispatch Dispatch;
+	return Dispatch;
+}
+
+void FSimAccelerationKernel::Accumulate
+(
+	const FSimAttractor& Attractor,
+	const double* PX, const double* PY, const double* PZ,
+	double* AX, double* AY, double* AZ,
+	int32 Begin,
+	int32 End
+)
+{
+	GetDispatch().Function(Attractor, PX, PY, PZ, AX, AY, AZ, Begin, End);
+}
+
+const TCHAR* FSimAccelerationKernel::GetInstructionSet()
+{
+	return GetDispatch().InstructionSet;
+}
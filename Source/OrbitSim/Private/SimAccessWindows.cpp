@@ -0,0 +1,250 @@
+// DHmelevcev 2025
+
+#include "SimAccessWindows.h"
+#include "Async/ParallelFor.h"
+
+// golden section ratio, 1 / phi
+constexpr double InvPhi = 0.6180339887498949;
+
+void FSimAccessPlanner::Reset
+(
+	const FSimStateStore& State,
+	const FDateTime& Start,
+	const TArray<FSimAccessStation>& iStations
+)
+{
+	NumSatellites = State.NumPhysic + State.NumAnalytic;
+
+	Bodies.SetNum(State.NumCelestial);
+	Stations.Reset(iStations.Num());
+
+	// the same turn as ASimGameMode gives celestial bodies
+	const double Seconds = (Start - FDateTime(1970, 1, 1)).GetTotalSeconds();
+
+	for (int32 c = 0; c < State.NumCelestial; ++c)
+	{
+		FBody& Body = Bodies[c];
+		const double Period = State.RotationPeriod[c];
+
+		Body.Radius = State.Radius[c] * 1e3;
+		Body.Spin = Period ? -TWO_PI / Period : 0;
+		Body.Angle = Period ? -TWO_PI * FMath::Fractional(Seconds / Period) : 0;
+		Body.Satellites.Reset();
+	}
+
+	for (const FSimAccessStation& iStation : iStations)
+	{
+		FStation& Station = Stations.Emplace_GetRef();
+
+		Station.Body = FMath::Clamp(iStation.Body, 0, FMath::Max(State.NumCelestial - 1, 0));
+		Station.Azimuth = -FMath::DegreesToRadians(iStation.Longitude + 180);
+
+		FMath::SinCos(&Station.SinLatitude, &Station.CosLatitude, FMath::DegreesToRadians(iStation.Latitude));
+	}
+
+	for (const FStation& Station : Stations)
+	{
+		FBody& Body = Bodies[Station.Body];
+
+		if (!Body.Satellites.IsEmpty())
+			continue;
+
+		Body.Satellites.SetNum(NumSatellites);
+
+		const FVector BodyPosition = State.Position.Get(Station.Body);
+		const FVector BodyVelocity = State.Velocity.Get(Station.Body);
+
+		for (int32 s = 0; s < NumSatellites; ++s)
+		{
+			FSatellite& Satellite = Body.Satellites[s];
+			const int32 Index = State.NumCelestial + s;
+
+			Satellite.Valid = FSimKeplerOrbit::FromState(
+				State.Position.Get(Index) - BodyPosition,
+				State.Velocity.Get(Index) - BodyVelocity,
+				State.GM[Station.Body], State.J2[Station.Body], State.Radius[Station.Body],
+				Satellite.Orbit);
+
+			if (!Satellite.Valid)
+				continue;
+
+			const double a = Satellite.Orbit.SemiMajorAxis;
+			const double e = Satellite.Orbit.Eccentricity;
+
+			// at the perigee, with a margin for J2
+			Satellite.MaxSpeed = 1.05 * FMath::Sqrt(Satellite.Orbit.Mu * (1 + e) / (a * (1 - e)));
+			Satellite.MinAltitude = a * (1 - e) - Body.Radius;
+
+			// crosses the surface
+			Satellite.Valid = Satellite.MinAltitude > 0;
+		}
+	}
+}
+
+double FSimAccessPlanner::GetElevation
+(
+	const FStation& Station,
+	const FSatellite& Satellite,
+	double Time,
+	double& OutRange
+) const
+{
+	const FBody& Body = Bodies[Station.Body];
+
+	FVector Position, Velocity;
+	Satellite.Orbit.Evaluate(Time, Position, Velocity);
+
+	double SinA, CosA;
+	FMath::SinCos(&SinA, &CosA, Body.Angle + Body.Spin * Time + Station.Azimuth);
+
+	const FVector Up(Station.CosLatitude * CosA, Station.CosLatitude * SinA, Station.SinLatitude);
+	const FVector Range = Position - Up * Body.Radius;
+
+	OutRange = Range.Size();
+
+	return OutRange > 0 ? FMath::Asin(FMath::Clamp(FVector::DotProduct(Range, Up) / OutRange, -1., 1.)) : HALF_PI;
+}
+
+void FSimAccessPlanner::ComputePair
+(
+	int32 StationIndex,
+	int32 SatelliteIndex,
+	double Duration,
+	TArray<FSimAccessWindow>& OutWindows
+) const
+{
+	const FStation& Station = Stations[StationIndex];
+	const FBody& Body = Bodies[Station.Body];
+	const FSatellite& Satellite = Body.Satellites[SatelliteIndex];
+
+	if (!Satellite.Valid)
+		return;
+
+	const double Mask = FMath::DegreesToRadians(MinElevation);
+	const double Spin = FMath::Abs(Body.Spin);
+
+	// the line of sight turns at most at the relative speed over the range,
+	// which can not be shorter than the lowest altitude, the zenith at Spin
+	const double Speed = Satellite.MaxSpeed + Spin * Body.Radius;
+	const double Altitude = Satellite.MinAltitude;
+
+	auto Elevation = [&](double Time)
+	{
+		double Range;
+		return GetElevation(Station, Satellite, Time, Range);
+	};
+
+	auto AddWindow = [&](double Rise, double Set)
+	{
+		FSimAccessWindow& Window = OutWindows.Emplace_GetRef();
+
+		Window.Station = StationIndex;
+		Window.Satellite = SatelliteIndex;
+		Window.Rise = Rise;
+		Window.Set = Set;
+
+		// passes have one culmination, clipped ones may peak at an end
+		double Low = Rise;
+		double High = Set;
+
+		while (High - Low > Tolerance)
+		{
+			const double First = High - InvPhi * (High - Low);
+			const double Second = Low + InvPhi * (High - Low);
+
+			if (Elevation(First) < Elevation(Second))
+				Low = First;
+			else
+				High = Second;
+		}
+
+		Window.Culmination = 0.5 * (Low + High);
+		double Peak = Elevation(Window.Culmination);
+
+		for (double End : { Rise, Set })
+		{
+			const double AtEnd = Elevation(End);
+
+			if (AtEnd > Peak)
+			{
+				Peak = AtEnd;
+				Window.Culmination = End;
+			}
+		}
+
+		Window.MaxElevation = FMath::RadiansToDegrees(Peak);
+	};
+
+	double Time = 0;
+	double Range;
+	double Current = GetElevation(Station, Satellite, 0, Range);
+
+	bool Visible = Current >= Mask;
+	double Rise = 0;
+
+	while (Time < Duration)
+	{
+		// the time the margin to the mask takes to run out with
+		// the range shrinking at Speed or at the lowest altitude
+		const double Margin = FMath::Abs(Current - Mask);
+		const double Step = FMath::Max(Margin * Range / (Speed * (1 + Margin) + Spin * Range),
+		                               Margin * Altitude / (Speed + Spin * Altitude));
+
+		const double Next = FMath::Min(Time + FMath::Clamp(Step, MinStep, MaxStep), Duration);
+		const double NextElevation = GetElevation(Station, Satellite, Next, Range);
+
+		if ((NextElevation >= Mask) != Visible)
+		{
+			// one crossing within the step
+			double Low = Time;
+			double High = Next;
+
+			while (High - Low > Tolerance)
+			{
+				const double Middle = 0.5 * (Low + High);
+
+				if ((Elevation(Middle) >= Mask) == Visible)
+					Low = Middle;
+				else
+					High = Middle;
+			}
+
+			const double Crossing = 0.5 * (Low + High);
+
+			if (Visible)
+				AddWindow(Rise, Crossing);
+			else
+				Rise = Crossing;
+
+			Visible = !Visible;
+		}
+
+		Time = Next;
+		Current = NextElevation;
+	}
+
+	if (Visible)
+		AddWindow(Rise, Duration);
+}
+
+void FSimAccessPlanner::Compute
+(
+	double Duration,
+	TArray<FSimAccessWindow>& OutWindows
+) const
+{
+	OutWindows.Reset();
+
+	const int32 NumPairs = Stations.Num() * NumSatellites;
+
+	TArray<TArray<FSimAccessWindow>> PairWindows;
+	PairWindows.SetNum(NumPairs);
+
+	ParallelFor(NumPairs, [&](int32 Pair)
+	{
+		ComputePair(Pair / NumSatellites, Pair % NumSatellites, FMath::Max(Duration, 0.), PairWindows[Pair]);
+	});
+
+	for (const auto& Windows : PairWindows)
+		OutWindows.Append(Windows);
+}
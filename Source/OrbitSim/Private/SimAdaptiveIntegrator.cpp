@@ -0,0 +1,410 @@
+// DHmelevcev 2025
+
+#include "SimAdaptiveIntegrator.h"
+
+// Dormand-Prince 5(4) coefficients
+namespace DOPRI
+{
+	constexpr double C2 = 1. / 5, C3 = 3. / 10, C4 = 4. / 5, C5 = 8. / 9;
+
+	constexpr double A21 = 1. / 5;
+	constexpr double A31 = 3. / 40, A32 = 9. / 40;
+	constexpr double A41 = 44. / 45, A42 = -56. / 15, A43 = 32. / 9;
+	constexpr double A51 = 19372. / 6561, A52 = -25360. / 2187, A53 = 64448. / 6561, A54 = -212. / 729;
+	constexpr double A61 = 9017. / 3168, A62 = -355. / 33, A63 = 46732. / 5247, A64 = 49. / 176, A65 = -5103. / 18656;
+	constexpr double A71 = 35. / 384, A73 = 500. / 1113, A74 = 125. / 192, A75 = -2187. / 6784, A76 = 11. / 84;
+
+	// difference between 5th and 4th order solutions
+	constexpr double E1 = 71. / 57600, E3 = -71. / 16695, E4 = 71. / 1920, E5 = -17253. / 339200, E6 = 22. / 525, E7 = -1. / 40;
+
+	// dense output
+	constexpr double D1 = -12715105075. / 11282082432, D3 = 87487479700. / 32700410799, D4 = -10690763975. / 1880347072,
+	                 D5 = 701980252875. / 199316789632, D6 = -1453857185. / 822651844, D7 = 69997945. / 29380423;
+}
+
+void FSimCelestialTrack::Reset
+(
+	const FSimStateStore& State,
+	double iStep
+)
+{
+	NumCelestial = State.NumCelestial;
+	NumSamples = 0;
+	Step = iStep;
+	StartTime = 0;
+
+	GM = State.GM;
+	J2 = State.J2;
+	Radius = State.Radius;
+
+	Positions.Reset();
+	Velocities.Reset();
+
+	Append(State);
+}
+
+void FSimCelestialTrack::Append
+(
+	const FSimStateStore& State
+)
+{
+	for (int32 i = 0; i < NumCelestial; ++i)
+	{
+		Positions.Emplace(State.Position.Get(i));
+		Velocities.Emplace(State.Velocity.Get(i));
+	}
+
+	++NumSamples;
+}
+
+void FSimCelestialTrack::Trim
+(
+	double Time
+)
+{
+	int32 Sample;
+	double Fraction;
+	Locate(Time, Sample, Fraction);
+
+	if (Sample <= 0)
+		return;
+
+	Positions.RemoveAt(0, Sample * NumCelestial, false);
+	Velocities.RemoveAt(0, Sample * NumCelestial, false);
+
+	NumSamples -= Sample;
+	StartTime += Sample * Step;
+}
+
+inline void FSimCelestialTrack::Locate
+(
+	double Time,
+	int32& OutSample,
+	double& OutFraction
+) const
+{
+	const double Position = (Time - StartTime) / Step;
+
+	OutSample = FMath::Clamp(FMath::FloorToInt32(Position), 0, FMath::Max(NumSamples - 2, 0));
+	OutFraction = Position - OutSample;
+}
+
+void FSimCelestialTrack::Evaluate
+(
+	double Time,
+	int32 Index,
+	FVector& OutPosition,
+	FVector& OutVelocity
+) const
+{
+	int32 Sample;
+	double s;
+	Locate(Time, Sample, s);
+
+	const int32 i0 = Sample * NumCelestial + Index;
+
+	if (NumSamples < 2)
+	{
+		OutPosition = Positions[i0];
+		OutVelocity = Velocities[i0];
+		return;
+	}
+
+	const int32 i1 = i0 + NumCelestial;
+
+	const double s2 = s * s;
+	const double s3 = s2 * s;
+
+	// cubic Hermite basis and its derivative
+	const double h00 = 2 * s3 - 3 * s2 + 1;
+	const double h10 = s3 - 2 * s2 + s;
+	const double h01 = -2 * s3 + 3 * s2;
+	const double h11 = s3 - s2;
+
+	const double d00 = 6 * s2 - 6 * s;
+	const double d10 = 3 * s2 - 4 * s + 1;
+	const double d01 = -6 * s2 + 6 * s;
+	const double d11 = 3 * s2 - 2 * s;
+
+	OutPosition = h00 * Positions[i0] + h10 * Step * Velocities[i0] +
+	              h01 * Positions[i1] + h11 * Step * Velocities[i1];
+
+	OutVelocity = (d00 * Positions[i0] + d01 * Positions[i1]) / Step +
+	              d10 * Velocities[i0] + d11 * Velocities[i1];
+}
+
+void FSimCelestialTrack::Evaluate
+(
+	double Time,
+	FSimAttractor* OutAttractors,
+	FVector& OutOriginAcceleration
+) const
+{
+	OutOriginAcceleration = FVector::Zero();
+
+	FVector Position, Velocity;
+
+	for (int32 i = 0; i < NumCelestial; ++i)
+	{
+		Evaluate(Time, i, Position, Velocity);
+
+		OutAttractors[i] = FSimAccelerationKernel::MakeAttractor(
+			Position.X, Position.Y, Position.Z, GM[i], J2[i], Radius[i]);
+
+		// origin stays at zero, only point masses act on it
+		if (i == 0 || GM[i] == 0)
+			continue;
+
+		const double r2 = Position.SizeSquared();
+		OutOriginAcceleration += Position * (GM[i] / (FMath::Sqrt(r2) * r2));
+	}
+}
+
+void FSimAdaptiveIntegrator::Reset
+(
+	const FSimStateStore& State,
+	double SampleStep
+)
+{
+	const int32 NumC = State.NumCelestial;
+
+	CelestialState.CopyCelestial(State);
+
+	Track.Reset(CelestialState, SampleStep);
+	LastTime = 0;
+
+	Bodies.SetNum(State.NumPhysic);
+
+	for (int32 i = 0; i < State.NumPhysic; ++i)
+	{
+		FBody& Body = Bodies[i];
+		const FVector Position = State.Position.Get(NumC + i);
+		const FVector Velocity = State.Velocity.Get(NumC + i);
+
+		Body.Y[0] = Position.X;
+		Body.Y[1] = Position.Y;
+		Body.Y[2] = Position.Z;
+		Body.Y[3] = Velocity.X;
+		Body.Y[4] = Velocity.Y;
+		Body.Y[5] = Velocity.Z;
+
+		Body.Time = 0;
+		Body.Step = FMath::Clamp(FMath::Abs(SampleStep), Settings.MinStep, Settings.MaxStep);
+		Body.LastStep = 0;
+		Body.Evaluations = 0;
+
+		// evaluated on first advance, the track is not ready yet
+		Body.HasDerivative = false;
+	}
+}
+
+void FSimAdaptiveIntegrator::PrepareTrack
+(
+	double Time,
+	TFunctionRef<void(FSimStateStore& CelestialState, double Time, double StepLength)> StepCelestial
+)
+{
+	const double Step = Track.GetStep();
+	const double Direction = FMath::Sign(Step);
+
+	// bodies step up to MaxStep past Time
+	const double Horizon = Time + Direction * (Settings.MaxStep + FMath::Abs(Step));
+
+	while (Direction * (Horizon - Track.GetEndTime()) > 0)
+	{
+		StepCelestial(CelestialState, Track.GetEndTime(), Step);
+		Track.Append(CelestialState);
+	}
+
+	// bodies are not behind the previous time
+	Track.Trim(LastTime);
+	LastTime = Time;
+}
+
+void FSimAdaptiveIntegrator::WriteCelestial
+(
+	FSimStateStore& State,
+	double Time
+) const
+{
+	FVector Position, Velocity;
+
+	for (int32 i = 1; i < State.NumCelestial; ++i)
+	{
+		Track.Evaluate(Time, i, Position, Velocity);
+
+		State.Position.Set(i, Position);
+		State.Velocity.Set(i, Velocity);
+	}
+}
+
+inline void FSimAdaptiveIntegrator::Derivative
+(
+	FBody& Body,
+	double Time,
+	const double* Y,
+	double* OutF
+) const
+{
+	const int32 NumC = Track.GetNumCelestial();
+
+	TArray<FSimAttractor, TInlineAllocator<8>> Attractors;
+	Attractors.SetNumUninitialized(NumC);
+
+	FVector OriginAcceleration;
+	Track.Evaluate(Time, Attractors.GetData(), OriginAcceleration);
+
+	double AX = 0, AY = 0, AZ = 0;
+
+	for (const auto& Attractor : Attractors)
+	{
+		if (Attractor.GM == 0)
+			continue;
+
+		FSimAccelerationKernel::AccumulateScalar(Attractor, Y, Y + 1, Y + 2, &AX, &AY, &AZ, 0, 1);
+	}
+
+	OutF[0] = Y[3];
+	OutF[1] = Y[4];
+	OutF[2] = Y[5];
+	OutF[3] = AX - OriginAcceleration.X;
+	OutF[4] = AY - OriginAcceleration.Y;
+	OutF[5] = AZ - OriginAcceleration.Z;
+
+	++Body.Evaluations;
+}
+
+inline void FSimAdaptiveIntegrator::Interpolate
+(
+	const FBody& Body,
+	double Time,
+	double* OutY
+) const
+{
+	if (Body.LastStep == 0 || Time == Body.Time)
+	{
+		FMemory::Memcpy(OutY, Body.Y, sizeof(Body.Y));
+		return;
+	}
+
+	const double Theta = 1 + (Time - Body.Time) / Body.LastStep;
+	const double Theta1 = 1 - Theta;
+
+	for (int32 n = 0; n < 6; ++n)
+	{
+		OutY[n] = Body.Dense[0][n] + Theta * (Body.Dense[1][n] + Theta1 * (
+		          Body.Dense[2][n] + Theta * (Body.Dense[3][n] + Theta1 *
+		          Body.Dense[4][n])));
+	}
+}
+
+void FSimAdaptiveIntegrator::AdvanceBody
+(
+	FSimStateStore& State,
+	int32 Index,
+	double Time
+)
+{
+	using namespace DOPRI;
+
+	FBody& Body = Bodies[Index - State.NumCelestial];
+
+	if (!Body.HasDerivative)
+	{
+		Derivative(Body, Body.Time, Body.Y, Body.F);
+		Body.HasDerivative = true;
+	}
+
+	const double Direction = GetDirection();
+	const double TrackEnd = Track.GetEndTime();
+
+	double K2[6], K3[6], K4[6], K5[6], K6[6], K7[6];
+	double Y1[6], Stage[6];
+
+	while (Direction * (Time - Body.Time) > 0)
+	{
+		double h = Direction * FMath::Min(Body.Step, FMath::Abs(TrackEnd - Body.Time));
+		const double* K1 = Body.F;
+		const double* Y0 = Body.Y;
+
+		for (int32 n = 0; n < 6; ++n)
+			Stage[n] = Y0[n] + h * A21 * K1[n];
+		Derivative(Body, Body.Time + C2 * h, Stage, K2);
+
+		for (int32 n = 0; n < 6; ++n)
+			Stage[n] = Y0[n] + h * (A31 * K1[n] + A32 * K2[n]);
+		Derivative(Body, Body.Time + C3 * h, Stage, K3);
+
+		for (int32 n = 0; n < 6; ++n)
+			Stage[n] = Y0[n] + h * (A41 * K1[n] + A42 * K2[n] + A43 * K3[n]);
+		Derivative(Body, Body.Time + C4 * h, Stage, K4);
+
+		for (int32 n = 0; n < 6; ++n)
+			Stage[n] = Y0[n] + h * (A51 * K1[n] + A52 * K2[n] + A53 * K3[n] + A54 * K4[n]);
+		Derivative(Body, Body.Time + C5 * h, Stage, K5);
+
+		for (int32 n = 0; n < 6; ++n)
+			Stage[n] = Y0[n] + h * (A61 * K1[n] + A62 * K2[n] + A63 * K3[n] + A64 * K4[n] + A65 * K5[n]);
+		Derivative(Body, Body.Time + h, Stage, K6);
+
+		for (int32 n = 0; n < 6; ++n)
+			Y1[n] = Y0[n] + h * (A71 * K1[n] + A73 * K3[n] + A74 * K4[n] + A75 * K5[n] + A76 * K6[n]);
+		Derivative(Body, Body.Time + h, Y1, K7);
+
+		// RMS of scaled error, velocity tolerance is PositionTolerance / 1000 s
+		double Error = 0;
+		for (int32 n = 0; n < 6; ++n)
+		{
+			const double Tolerance = (n < 3 ? 1. : 1e-3) * Settings.PositionTolerance +
+				Settings.RelativeTolerance * FMath::Max(FMath::Abs(Y0[n]), FMath::Abs(Y1[n]));
+
+			const double e = h * (E1 * K1[n] + E3 * K3[n] + E4 * K4[n] + E5 * K5[n] + E6 * K6[n] + E7 * K7[n]) / Tolerance;
+			Error += e * e;
+		}
+		Error = FMath::Sqrt(Error / 6);
+
+		const double Factor = Error > 0 ? 0.9 * FMath::Pow(Error, -0.2) : 5.;
+
+		if (Error > 1 && FMath::Abs(h) > Settings.MinStep)
+		{
+			Body.Step = FMath::Max(FMath::Abs(h) * FMath::Max(Factor, 0.2), Settings.MinStep);
+			continue;
+		}
+
+		// accepted, dense output over the step
+		for (int32 n = 0; n < 6; ++n)
+		{
+			const double Difference = Y1[n] - Y0[n];
+			const double Spline = h * K1[n] - Difference;
+
+			Body.Dense[0][n] = Y0[n];
+			Body.Dense[1][n] = Difference;
+			Body.Dense[2][n] = Spline;
+			Body.Dense[3][n] = Difference - h * K7[n] - Spline;
+			Body.Dense[4][n] = h * (D1 * K1[n] + D3 * K3[n] + D4 * K4[n] + D5 * K5[n] + D6 * K6[n] + D7 * K7[n]);
+		}
+
+		FMemory::Memcpy(Body.Y, Y1, sizeof(Y1));
+		FMemory::Memcpy(Body.F, K7, sizeof(K7));
+		Body.Time += h;
+		Body.LastStep = h;
+
+		Body.Step = FMath::Clamp(FMath::Abs(h) * FMath::Min(Factor, 5.), Settings.MinStep, Settings.MaxStep);
+	}
+
+	double Y[6];
+	Interpolate(Body, Time, Y);
+
+	State.Position.Set(Index, FVector(Y[0], Y[1], Y[2]));
+	State.Velocity.Set(Index, FVector(Y[3], Y[4], Y[5]));
+}
+
+int64 FSimAdaptiveIntegrator::GetNumEvaluations() const
+{
+	int64 Evaluations = 0;
+
+	for (const auto& Body : Bodies)
+		Evaluations += Body.Evaluations;
+
+	return Evaluations;
+}
@@ -0,0 +1,230 @@
+// DHmelevcev 2025
+
+#include "SimAnalyticPropagator.h"
+
+bool FSimKeplerOrbit::FromState
+(
+	const FVector& Position,
+	const FVector& Velocity,
+	double iMu,
+	double J2,
+	double Radius,
+	FSimKeplerOrbit& OutOrbit
+)
+{
+	const double r = Position.Size();
+	const double v2 = Velocity.SizeSquared();
+
+	const FVector h = FVector::CrossProduct(Position, Velocity);
+	const double norm_h = h.Size();
+
+	if (r == 0 || norm_h == 0 || iMu <= 0)
+		return false;
+
+	// only bound orbits
+	const double a = 1 / (2 / r - v2 / iMu);
+	if (a <= 0)
+		return false;
+
+	const FVector e = ((v2 - iMu / r) * Position - FVector::DotProduct(Position, Velocity) * Velocity) / iMu;
+	const double norm_e = e.Size();
+	if (norm_e >= 1)
+		return false;
+
+	OutOrbit.Mu = iMu;
+	OutOrbit.SemiMajorAxis = a;
+	OutOrbit.Eccentricity = norm_e;
+
+	OutOrbit.P = norm_e > 1e-9 ? e / norm_e : Position / r;
+	OutOrbit.Q = FVector::CrossProduct(h / norm_h, OutOrbit.P);
+
+	// true anomaly -> eccentric anomaly -> mean anomaly
+	const double cosnu = FVector::DotProduct(Position, OutOrbit.P) / r;
+	const double sinnu = FVector::DotProduct(Position, OutOrbit.Q) / r;
+	const double b = FMath::Sqrt(1 - norm_e * norm_e);
+	const double E = FMath::Atan2(b * sinnu, norm_e + cosnu);
+
+	OutOrbit.MeanAnomaly = E - norm_e * FMath::Sin(E);
+
+	const FVector hn = h / norm_h;
+	const double cosi = hn.Z;
+	const double R2 = FMath::Square(1000. * Radius);
+
+	// argument of latitude, node is arbitrary on equatorial orbits
+	FVector Node(-hn.Y, hn.X, 0);
+	Node = Node.SizeSquared() > 1e-20 ? Node.GetUnsafeNormal() : FVector::XAxisVector;
+
+	const double cosu = FVector::DotProduct(Position, Node) / r;
+	const double sinu = FVector::DotProduct(Position, FVector::CrossProduct(hn, Node)) / r;
+
+	// remove first order short periodic J2 term from semi-major axis,
+	// the osculating one gives a wrong mean motion near the perigee
+	const double ar3 = FMath::Cube(a / r);
+	const double da = J2 * R2 / (2 * a) * ((3 * cosi * cosi - 1) * (ar3 - 1 / FMath::Cube(b)) +
+	                                      3 * (1 - cosi * cosi) * ar3 * (cosu * cosu - sinu * sinu));
+
+	OutOrbit.SemiMajorAxis = a - da;
+
+	const double MeanA = OutOrbit.SemiMajorAxis;
+	const double n0 = FMath::Sqrt(iMu / (MeanA * MeanA * MeanA));
+
+	// secular J2 rates
+	const double p = MeanA * (1 - norm_e * norm_e);
+	const double k = J2 * R2 / (p * p);
+
+	OutOrbit.NodeRate = -1.5 * n0 * k * cosi;
+	OutOrbit.PerigeeRate = 0.75 * n0 * k * (5 * cosi * cosi - 1);
+	OutOrbit.MeanMotion = n0 * (1 + 0.75 * k * b * (3 * cosi * cosi - 1));
+
+	return true;
+}
+
+void FSimKeplerOrbit::Evaluate
+(
+	double Time,
+	FVector& OutPosition,
+	FVector& OutVelocity
+) const
+{
+	const double e = Eccentricity;
+
+	// perigee drift inside the orbit plane
+	const double dw = PerigeeRate * Time;
+	const double cosw = FMath::Cos(dw);
+	const double sinw = FMath::Sin(dw);
+
+	FVector P1 = P * cosw + Q * sinw;
+	FVector Q1 = Q * cosw - P * sinw;
+
+	// node drift around the pole
+	const double dO = NodeRate * Time;
+	const double cosO = FMath::Cos(dO);
+	const double sinO = FMath::Sin(dO);
+
+	P1 = FVector(P1.X * cosO - P1.Y * sinO, P1.X * sinO + P1.Y * cosO, P1.Z);
+	Q1 = FVector(Q1.X * cosO - Q1.Y * sinO, Q1.X * sinO + Q1.Y * cosO, Q1.Z);
+
+	// Kepler equation, Newton iterations
+	const double M = FMath::Fmod(MeanAnomaly + MeanMotion * Time, TWO_PI);
+	double E = e < 0.8 ? M : PI * FMath::Sign(M);
+
+	for (int32 k = 0; k < 32; ++k)
+	{
+		const double dE = (E - e * FMath::Sin(E) - M) / (1 - e * FMath::Cos(E));
+		E -= dE;
+
+		if (FMath::Abs(dE) < 1e-14)
+			break;
+	}
+
+	const double cosE = FMath::Cos(E);
+	const double sinE = FMath::Sin(E);
+	const double b = FMath::Sqrt(1 - e * e);
+
+	OutPosition = SemiMajorAxis * ((cosE - e) * P1 + b * sinE * Q1);
+
+	const double temp0 = FMath::Sqrt(Mu * SemiMajorAxis) / OutPosition.Size();
+	OutVelocity = temp0 * (b * cosE * Q1 - sinE * P1);
+}
+
+int32 FSimAnalyticPropagator::FindCentral
+(
+	const FSimStateStore& State,
+	int32 Index
+)
+{
+	const double SelfGM = Index < State.NumCelestial ? State.GM[Index] : 0;
+	const FVector Position = State.Position.Get(Index);
+
+	// heavier body with the largest tidal acceleration,
+	// bodies heavier than everything else orbit the origin
+	int32 Central = 0;
+	double MaxTidal = 0;
+
+	for (int32 c = 0; c < State.NumCelestial; ++c)
+	{
+		if (c == Index || State.GM[c] <= SelfGM)
+			continue;
+
+		const double r = (Position - State.Position.Get(c)).Size();
+		const double Tidal = State.GM[c] / (r * r * r);
+
+		if (Tidal > MaxTidal)
+		{
+			MaxTidal = Tidal;
+			Central = c;
+		}
+	}
+
+	return Central;
+}
+
+void FSimAnalyticPropagator::Reset
+(
+	const FSimStateStore& State,
+	int32 iBegin
+)
+{
+	Begin = FMath::Max(iBegin, 1);
+
+	const int32 NumAll = State.Num();
+
+	Orbits.SetNum(FMath::Max(NumAll - Begin, 0));
+	Valid.SetNum(Orbits.Num());
+	CelestialOrder.Reset();
+
+	for (int32 i = Begin; i < NumAll; ++i)
+	{
+		const bool Celestial = i < State.NumCelestial;
+		const int32 Central = FindCentral(State, i);
+
+		FSimKeplerOrbit& Orbit = Orbits[i - Begin];
+
+		// mutual point mass attraction only between celestial bodies
+		const double Mu = State.GM[Central] + (Celestial ? State.GM[i] : 0);
+		const double J2 = Celestial ? 0 : State.J2[Central];
+
+		Valid[i - Begin] = FSimKeplerOrbit::FromState(
+			State.Position.Get(i) - State.Position.Get(Central),
+			State.Velocity.Get(i) - State.Velocity.Get(Central),
+			Mu, J2, State.Radius[Central], Orbit);
+
+		Orbit.Central = Central;
+
+		if (Celestial)
+			CelestialOrder.Emplace(i);
+	}
+
+	// central bodies are heavier unless they are the origin
+	CelestialOrder.Sort([&State](int32 A, int32 B)
+	{
+		return State.GM[A] > State.GM[B];
+	});
+}
+
+void FSimAnalyticPropagator::Evaluate
+(
+	FSimStateStore& State,
+	double Time
+) const
+{
+	FVector Position, Velocity;
+
+	auto EvaluateBody = [&](int32 i)
+	{
+		if (!Valid[i - Begin])
+			return;
+
+		const FSimKeplerOrbit& Orbit = Orbits[i - Begin];
+		Orbit.Evaluate(Time, Position, Velocity);
+
+		State.Position.Set(i, State.Position.Get(Orbit.Central) + Position);
+		State.Velocity.Set(i, State.Velocity.Get(Orbit.Central) + Velocity);
+	};
+
+	for (int32 i : CelestialOrder)
+		EvaluateBody(i);
+
+	for (int32 i = FMath::Max(Begin, State.NumCelestial); i < State.Num(); ++i)
+		EvaluateBody(i);
+}
@@ -37,10 +37,3 @@ void ASimBody::BeginPlay()
 			ASimGameMode::dtSeconds / TrajectoryLines;
 	}
 }
-
-inline void ASimBody::ClearBuffers()
-{
-	P[0] = P[1] = P[2] = P[3] = Position;
-	V[0] = V[1] = V[2] = V[3] = Velocity;
-	A[0] = A[1] = A[2] = A[3] = FVector::Zero();
-}
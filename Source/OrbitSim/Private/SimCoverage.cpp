@@ -0,0 +1,304 @@
+// DHmelevcev 2025
+
+#include "SimCoverage.h"
+#include "Async/ParallelFor.h"
+
+FSimCoverage::FSimCoverage
+(
+	ESimCoverageGrid iGrid,
+	double Resolution,
+	const TArray<int32>& iFolds
+) :
+	Grid(iGrid),
+	Folds(iFolds)
+{
+	const int32 NumRows = FMath::Max(FMath::RoundToInt32(180 / FMath::Max(Resolution, 0.01)), 1);
+	const double Height = 180. / NumRows;
+
+	Rows.SetNumUninitialized(NumRows);
+
+	int32 NumCells = 0;
+
+	for (int32 j = 0; j < NumRows; ++j)
+	{
+		FRow& Row = Rows[j];
+		const double Latitude = 90 - (j + 0.5) * Height;
+
+		FMath::SinCos(&Row.Sin, &Row.Cos, FMath::DegreesToRadians(Latitude));
+
+		// cells of a ring keep about the area of equatorial ones
+		Row.Num = Grid == ESimCoverageGrid::EqualArea ?
+		          FMath::Max(FMath::RoundToInt32(2 * NumRows * Row.Cos), 1) :
+		          2 * NumRows;
+
+		Row.Offset = NumCells;
+		Row.Width = 360. / Row.Num;
+
+		FMath::SinCos(&Row.StepSin, &Row.StepCos, FMath::DegreesToRadians(-Row.Width));
+
+		NumCells += Row.Num;
+	}
+
+	Current.SetNumZeroed(NumCells);
+	Values.SetNumUninitialized(NumCells);
+	Minimum.SetNumUninitialized(NumCells);
+	Maximum.SetNumUninitialized(NumCells);
+	FoldSamples.SetNumUninitialized(NumCells * Folds.Num());
+	OutageStart.SetNumUninitialized(NumCells);
+	LongestOutage.SetNumUninitialized(NumCells);
+	OutageSum.SetNumUninitialized(NumCells);
+	NumOutages.SetNumUninitialized(NumCells);
+
+	Reset();
+}
+
+void FSimCoverage::Reset()
+{
+	const int32 NumCells = Values.Num();
+
+	FMemory::Memzero(Values.GetData(), NumCells * sizeof(double));
+	FMemory::Memzero(Maximum.GetData(), NumCells * sizeof(uint16));
+	FMemory::Memzero(FoldSamples.GetData(), FoldSamples.Num() * sizeof(int32));
+	FMemory::Memzero(LongestOutage.GetData(), NumCells * sizeof(double));
+	FMemory::Memzero(OutageSum.GetData(), NumCells * sizeof(double));
+	FMemory::Memzero(NumOutages.GetData(), NumCells * sizeof(int32));
+
+	for (int32 i = 0; i < NumCells; ++i)
+	{
+		Minimum[i] = MAX_uint16;
+		OutageStart[i] = -1;
+	}
+
+	NumSamples = 0;
+	LastTime = 0;
+}
+
+double FSimCoverage::GetRowLatitude
+(
+	int32 Row
+) const
+{
+	return 90 - (Row + 0.5) * 180. / Rows.Num();
+}
+
+double FSimCoverage::GetCellLongitude
+(
+	int32 Row,
+	int32 Cell
+) const
+{
+	return (Cell + 0.5) * Rows[Row].Width - 180;
+}
+
+void FSimCoverage::Accumulate
+(
+	const FDateTime& Time,
+	const TArray<FVector>& Positions,
+	double Radius,
+	double Rotation,
+	float* OutSample
+)
+{
+	const double Height = 180. / Rows.Num();
+
+	// satellites to body-fixed coordinates instead of rotating every cell
+	const FRotator ToBody(0, -Rotation, 0);
+
+	if (NumSamples == 0)
+		FirstTime = Time;
+
+	const double Now = (Time - FirstTime).GetTotalSeconds();
+	const int32 NumFolds = Folds.Num();
+
+	Satellites.Reset(Positions.Num());
+
+	for (const auto& Position : Positions)
+	{
+		FSimFootprint Footprint;
+
+		if (!Footprint.Set(ToBody.RotateVector(Position), Radius))
+			continue;
+
+		FSatellite& Satellite = Satellites.Emplace_GetRef();
+
+		Satellite.Footprint = Footprint;
+		Footprint.GetRows(Height, Rows.Num(), Satellite.FirstRow, Satellite.LastRow);
+	}
+
+	ParallelFor(Rows.Num(), [&](int32 j)
+	{
+		const FRow& Row = Rows[j];
+		uint16* RowCurrent = &Current[Row.Offset];
+
+		for (const auto& Satellite : Satellites)
+		{
+			if (j < Satellite.FirstRow || j > Satellite.LastRow)
+				continue;
+
+			const FSimFootprint& Footprint = Satellite.Footprint;
+
+			// cells are at the latitude of the row centre
+			int32 First, Last;
+			if (!Footprint.GetColumns(Row.Sin, Row.Cos, Row.Width, Row.Num, First, Last))
+				continue;
+
+			// cell i of a row points to 360 - (i + 0.5) * Width deg.,
+			// directions by rotating from the first one
+			double SinA, CosA;
+			FMath::SinCos(&SinA, &CosA, FMath::DegreesToRadians(360 - (First + 0.5) * Row.Width));
+
+			for (int32 c = First; c <= Last; ++c)
+			{
+				if (Footprint.IsVisible(FVector(Row.Cos * CosA, Row.Cos * SinA, Row.Sin)))
+					++RowCurrent[(c % Row.Num + Row.Num) % Row.Num];
+
+				const double NextCos = CosA * Row.StepCos - SinA * Row.StepSin;
+				SinA = SinA * Row.StepCos + CosA * Row.StepSin;
+				CosA = NextCos;
+			}
+		}
+
+		// statistics of every cell of the row, untouched cells see nothing
+		for (int32 k = Row.Offset; k < Row.Offset + Row.Num; ++k)
+		{
+			const uint16 Count = Current[k];
+			Current[k] = 0;
+
+			if (OutSample)
+				OutSample[k] = Count;
+
+			Values[k] += Count;
+			Minimum[k] = FMath::Min(Minimum[k], Count);
+			Maximum[k] = FMath::Max(Maximum[k], Count);
+
+			for (int32 f = 0; f < NumFolds; ++f)
+				if (Count >= Folds[f])
+					++FoldSamples[k * NumFolds + f];
+
+			if (Count == 0)
+			{
+				if (OutageStart[k] < 0)
+					OutageStart[k] = Now;
+			}
+			else if (OutageStart[k] >= 0)
+			{
+				const double Outage = Now - OutageStart[k];
+
+				LongestOutage[k] = FMath::Max(LongestOutage[k], Outage);
+				OutageSum[k] += Outage;
+				++NumOutages[k];
+
+				OutageStart[k] = -1;
+			}
+		}
+	});
+
+	++NumSamples;
+	LastTime = Now;
+}
+
+TArray<double> FSimCoverage::GetAverage() const
+{
+	TArray<double> Average = Values;
+
+	if (NumSamples > 0)
+		for (auto& Value : Average)
+			Value /= NumSamples;
+
+	return Average;
+}
+
+TArray<double> FSimCoverage::GetMinimum() const
+{
+	TArray<double> Result;
+	Result.SetNumUninitialized(Minimum.Num());
+
+	for (int32 i = 0; i < Minimum.Num(); ++i)
+		Result[i] = NumSamples > 0 ? Minimum[i] : 0;
+
+	return Result;
+}
+
+TArray<double> FSimCoverage::GetMaximum() const
+{
+	TArray<double> Result;
+	Result.SetNumUninitialized(Maximum.Num());
+
+	for (int32 i = 0; i < Maximum.Num(); ++i)
+		Result[i] = Maximum[i];
+
+	return Result;
+}
+
+TArray<double> FSimCoverage::GetFoldFraction
+(
+	int32 Fold
+) const
+{
+	TArray<double> Result;
+	Result.SetNumZeroed(Values.Num());
+
+	if (NumSamples > 0 && Folds.IsValidIndex(Fold))
+		for (int32 i = 0; i < Result.Num(); ++i)
+			Result[i] = static_cast<double>(FoldSamples[i * Folds.Num() + Fold]) / NumSamples;
+
+	return Result;
+}
+
+TArray<double> FSimCoverage::GetLongestOutage() const
+{
+	TArray<double> Result = LongestOutage;
+
+	// running outages last until the last sample
+	for (int32 i = 0; i < Result.Num(); ++i)
+		if (OutageStart[i] >= 0)
+			Result[i] = FMath::Max(Result[i], LastTime - OutageStart[i]);
+
+	return Result;
+}
+
+TArray<double> FSimCoverage::GetMeanRevisit() const
+{
+	TArray<double> Result;
+	Result.SetNumUninitialized(Values.Num());
+
+	for (int32 i = 0; i < Result.Num(); ++i)
+	{
+		double Sum = OutageSum[i];
+		int32 Num = NumOutages[i];
+
+		if (OutageStart[i] >= 0)
+		{
+			Sum += LastTime - OutageStart[i];
+			++Num;
+		}
+
+		Result[i] = Num > 0 ? Sum / Num : 0;
+	}
+
+	return Result;
+}
+
+TArray<double> FSimCoverage::Render
+(
+	const TArray<double>& CellValues,
+	int32& OutWidth,
+	int32& OutHeight
+) const
+{
+	OutHeight = Rows.Num();
+	OutWidth = 2 * Rows.Num();
+
+	TArray<double> Image;
+	Image.SetNumUninitialized(OutWidth * OutHeight);
+
+	for (int32 j = 0; j < OutHeight; ++j)
+	{
+		const FRow& Row = Rows[j];
+
+		for (int32 x = 0; x < OutWidth; ++x)
+			Image[j * OutWidth + x] = CellValues[Row.Offset + x * Row.Num / OutWidth];
+	}
+
+	return Image;
+}
@@ -0,0 +1,213 @@
+// DHmelevcev 2025
+
+#include "SimCoverageCube.h"
+#include "SimCoverage.h"
+#include "Async/MappedFileHandle.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+
+// bytes of samples collected before a write
+constexpr int64 CubeChunkSize = 4 << 20;
+
+FSimCoverageCubeWriter::~FSimCoverageCubeWriter()
+{
+	Close();
+}
+
+bool FSimCoverageCubeWriter::Open
+(
+	const FString& File,
+	const FSimCoverage& Coverage
+)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(File));
+	Handle.Reset(PlatformFile.OpenWrite(*File));
+
+	if (!Handle)
+		return false;
+
+	const int32 NumRows = Coverage.GetNumRows();
+
+	Header = FSimCoverageCubeHeader();
+	Header.Grid = static_cast<int32>(Coverage.GetGrid());
+	Header.NumRows = NumRows;
+	Header.NumCells = Coverage.GetNumCells();
+	Header.DataOffset = Align(sizeof(FSimCoverageCubeHeader) + 2 * sizeof(int32) * NumRows, 8);
+	Header.RecordSize = Align(sizeof(int64) + sizeof(float) * Header.NumCells, 8);
+
+	TArray<uint8> Prefix;
+	Prefix.SetNumZeroed(Header.DataOffset);
+
+	FMemory::Memcpy(Prefix.GetData(), &Header, sizeof(Header));
+
+	int32* Rows = reinterpret_cast<int32*>(Prefix.GetData() + sizeof(Header));
+
+	for (int32 j = 0; j < NumRows; ++j)
+	{
+		Rows[2 * j] = Coverage.GetRowOffset(j);
+		Rows[2 * j + 1] = Coverage.GetRowNum(j);
+	}
+
+	Failed = !Handle->Write(Prefix.GetData(), Prefix.Num());
+
+	ChunkSamples = FMath::Max(static_cast<int32>(CubeChunkSize / Header.RecordSize), 1);
+	Chunk.SetNumZeroed(ChunkSamples * Header.RecordSize);
+	NumBuffered = 0;
+
+	return !Failed;
+}
+
+float* FSimCoverageCubeWriter::AddSample
+(
+	const FDateTime& Time
+)
+{
+	if (!Handle)
+		return nullptr;
+
+	if (NumBuffered == ChunkSamples)
+		Flush();
+
+	uint8* Record = Chunk.GetData() + NumBuffered * Header.RecordSize;
+	const int64 Ticks = Time.GetTicks();
+
+	FMemory::Memcpy(Record, &Ticks, sizeof(Ticks));
+
+	++NumBuffered;
+	++Header.NumSamples;
+
+	return reinterpret_cast<float*>(Record + sizeof(int64));
+}
+
+bool FSimCoverageCubeWriter::Flush()
+{
+	if (NumBuffered > 0 && !Failed)
+		Failed = !Handle->Write(Chunk.GetData(), NumBuffered * Header.RecordSize);
+
+	NumBuffered = 0;
+
+	return !Failed;
+}
+
+bool FSimCoverageCubeWriter::Close()
+{
+	if (!Handle)
+		return false;
+
+	// the count at its place in the header
+	bool Result = Flush() &&
+	              Handle->Seek(STRUCT_OFFSET(FSimCoverageCubeHeader, NumSamples)) &&
+	              Handle->Write(reinterpret_cast<const uint8*>(&Header.NumSamples), sizeof(Header.NumSamples));
+
+	Result = Handle->Flush() && Result;
+
+	Handle.Reset();
+	Chunk.Empty();
+
+	return Result;
+}
+
+FSimCoverageCubeReader::~FSimCoverageCubeReader()
+{
+	Close();
+}
+
+bool FSimCoverageCubeReader::Open
+(
+	const FString& File
+)
+{
+	Close();
+
+	auto Result = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*File);
+
+	if (Result.HasError())
+		return false;
+
+	Handle = Result.StealValue();
+
+	const int64 FileSize = Handle->GetFileSize();
+
+	if (FileSize < static_cast<int64>(sizeof(FSimCoverageCubeHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	Region.Reset(Handle->MapRegion(0, FileSize));
+
+	if (!Region)
+	{
+		Close();
+		return false;
+	}
+
+	Data = Region->GetMappedPtr();
+
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+
+	if (Header.Magic != FSimCoverageCubeHeader::FileMagic ||
+		Header.Version != FSimCoverageCubeHeader::FileVersion ||
+		Header.NumRows <= 0 || Header.NumCells <= 0 ||
+		Header.DataOffset > FileSize ||
+		Header.RecordSize < static_cast<int64>(sizeof(int64) + sizeof(float) * Header.NumCells))
+	{
+		Close();
+		return false;
+	}
+
+	// an unfinished file has whole records up to where it was cut
+	NumSamples = (FileSize - Header.DataOffset) / Header.RecordSize;
+
+	if (Header.NumSamples > 0)
+		NumSamples = FMath::Min(NumSamples, Header.NumSamples);
+
+	return true;
+}
+
+void FSimCoverageCubeReader::Close()
+{
+	Region.Reset();
+	Handle.Reset();
+
+	Data = nullptr;
+	NumSamples = 0;
+}
+
+void FSimCoverageCubeReader::GetRow
+(
+	int32 Row,
+	int32& OutOffset,
+	int32& OutNum
+) const
+{
+	const int32* Rows = reinterpret_cast<const int32*>(Data + sizeof(FSimCoverageCubeHeader));
+
+	OutOffset = Rows[2 * Row];
+	OutNum = Rows[2 * Row + 1];
+}
+
+FDateTime FSimCoverageCubeReader::GetTime
+(
+	int64 Sample
+) const
+{
+	int64 Ticks;
+	FMemory::Memcpy(&Ticks, Data + Header.DataOffset + Sample * Header.RecordSize, sizeof(Ticks));
+
+	return FDateTime(Ticks);
+}
+
+TArrayView<const float> FSimCoverageCubeReader::GetSample
+(
+	int64 Sample
+) const
+{
+	const uint8* Record = Data + Header.DataOffset + Sample * Header.RecordSize;
+
+	return TArrayView<const float>(reinterpret_cast<const float*>(Record + sizeof(int64)), Header.NumCells);
+}
@@ -0,0 +1,55 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// instruction sets of vectorized kernels, checked at run time
+
+#if PLATFORM_CPU_X86_FAMILY
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define SIM_TARGET_AVX2
+		#define SIM_TARGET_AVX512
+	#else
+		#define SIM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+		#define SIM_TARGET_AVX512 __attribute__((target("avx512f")))
+	#endif
+
+inline bool HasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int32 Info[4];
+	__cpuid(Info, 1);
+	const bool bOSXSave = (Info[2] & (1 << 27)) != 0;
+	const bool bFMA = (Info[2] & (1 << 12)) != 0;
+	if (!bOSXSave || !bFMA || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(Info, 7, 0);
+	return (Info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+inline bool HasAVX512()
+{
+	if (!HasAVX2())
+		return false;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	// opmask and upper zmm state enabled by OS
+	if ((_xgetbv(0) & 0xe6) != 0xe6)
+		return false;
+
+	int32 Info[4];
+	__cpuidex(Info, 7, 0);
+	return (Info[1] & (1 << 16)) != 0;
+#else
+	return __builtin_cpu_supports("avx512f");
+#endif
+}
+
+#endif // PLATFORM_CPU_X86_FAMILY
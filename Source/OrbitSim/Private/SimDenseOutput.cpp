@@ -0,0 +1,93 @@
+// DHmelevcev 2025
+
+#include "SimDenseOutput.h"
+#include "SimEngine.h"
+
+void FSimDenseOutput::BeginStep
+(
+	const FSimEngine& Engine
+)
+{
+	const FSimStateStore& State = Engine.State;
+
+	Positions.Reset(State.Num() - State.NumCelestial);
+	Velocities.Reset(State.Num() - State.NumCelestial);
+
+	for (int32 i = State.NumCelestial; i < State.Num(); ++i)
+	{
+		Positions.Emplace(State.Position.Get(i));
+		Velocities.Emplace(State.Velocity.Get(i));
+	}
+
+	Start = Engine.UpdatedTo;
+	Valid = false;
+}
+
+void FSimDenseOutput::EndStep
+(
+	const FSimEngine& Engine
+)
+{
+	End = Engine.UpdatedTo;
+	Valid = Positions.Num() == Engine.State.Num() - Engine.State.NumCelestial;
+}
+
+bool FSimDenseOutput::Covers
+(
+	const FSimEngine& Engine,
+	const FDateTime& Time
+) const
+{
+	if (Time == Engine.UpdatedTo)
+		return true;
+
+	// the state was replaced or advanced without BeginStep
+	if (!Valid || End != Engine.UpdatedTo || Start == End)
+		return false;
+
+	return Start < End ? Start <= Time && Time <= End :
+	                     End <= Time && Time <= Start;
+}
+
+bool FSimDenseOutput::GetPositions
+(
+	const FSimEngine& Engine,
+	const FDateTime& Time,
+	TArray<FVector>& OutPositions
+) const
+{
+	// never extrapolate past the step or from a stale one
+	if (!Covers(Engine, Time))
+		return false;
+
+	if (Time == Engine.UpdatedTo)
+	{
+		Engine.GetPhysicPositions(OutPositions);
+		return true;
+	}
+
+	const FSimStateStore& State = Engine.State;
+
+	// signed step length, s from 0 at Start to 1 at End
+	const double h = (End - Start).GetTotalSeconds();
+	const double s = (Time - Start).GetTotalSeconds() / h;
+	const double s2 = s * s;
+	const double s3 = s2 * s;
+
+	const double h00 = 2 * s3 - 3 * s2 + 1;
+	const double h10 = (s3 - 2 * s2 + s) * h;
+	const double h01 = 3 * s2 - 2 * s3;
+	const double h11 = (s3 - s2) * h;
+
+	OutPositions.SetNumUninitialized(Positions.Num());
+
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		const int32 Index = State.NumCelestial + i;
+
+		OutPositions[i] = h00 * Positions[i] + h10 * Velocities[i] +
+		                  h01 * State.Position.Get(Index) + h11 * State.Velocity.Get(Index);
+	}
+
+	return true;
+}
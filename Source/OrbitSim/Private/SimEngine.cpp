@@ -0,0 +1,731 @@
+// DHmelevcev 2025
+
+#include "SimEngine.h"
+#include "Async/ParallelFor.h"
+#include "SimAccelerationKernel.h"
+
+void FSimEngine::Reset
+(
+	const TArray<FString>& CelestialNames
+)
+{
+	AdaptiveReady = false;
+	MultistepReady = false;
+
+	// celestial bodies are matched to the ephemeris by name
+	EphemerisBodies.Reset();
+
+	for (const auto& Name : CelestialNames)
+	{
+		const int32 Index = Ephemeris.Find(Name);
+
+		if (Index == INDEX_NONE || EphemerisBodies.Contains(Index))
+			break;
+
+		EphemerisBodies.Emplace(Index);
+	}
+
+	EphemerisReady = Ephemeris.Num() > 0 &&
+	                 EphemerisBodies.Num() == CelestialNames.Num() &&
+	                 CelestialNames.Num() == State.NumCelestial;
+
+	if (Ephemeris.Num() > 0 && !EphemerisReady)
+		UE_LOG(LogTemp, Warning, TEXT("Ephemeris does not contain all celestial bodies, they are integrated"));
+
+	if (IsOnEphemeris(GetEphemerisTime(UpdatedTo), 0))
+		LoadCelestialState(State, GetEphemerisTime(UpdatedTo));
+
+	const bool FullyAnalytic = Settings.Propagation == ESimPropagation::Analytic;
+
+	AnalyticReady = FullyAnalytic || State.NumAnalytic;
+
+	if (AnalyticReady)
+	{
+		AnalyticPropagator.Reset(State, FullyAnalytic ? 1 : State.NumCelestial + State.NumPhysic);
+		AnalyticEpoch = UpdatedTo;
+	}
+}
+
+bool FSimEngine::IsAhead
+(
+	const FDateTime& Target,
+	int32 Direction
+) const
+{
+	// never turn back
+	return Direction > 0 ? UpdatedTo + dt < Target :
+	       Direction < 0 ? UpdatedTo > Target : false;
+}
+
+int64 FSimEngine::Skip
+(
+	const FDateTime& Target,
+	int32 Direction
+)
+{
+	if (Settings.Propagation != ESimPropagation::Analytic || !IsAhead(Target, Direction))
+		return 0;
+
+	// state at any time is closed form, stop short of Target both ways
+	// so the step that reaches it can still be taken
+	const int64 Ticks = FMath::Abs((Target - UpdatedTo).GetTicks());
+	const int64 Steps = (Ticks - 1) / dt.GetTicks();
+
+	if (Steps > 0)
+	{
+		UpdatedTo += FTimespan(Direction * Steps * dt.GetTicks());
+
+		AnalyticPropagator.Evaluate(State, (UpdatedTo - AnalyticEpoch).GetTotalSeconds());
+	}
+
+	return Steps;
+}
+
+void FSimEngine::Step
+(
+	int32 Direction
+)
+{
+	const double StepTime = GetEphemerisTime(UpdatedTo);
+
+	UpdatedTo += Direction * dt;
+
+	if (Settings.Propagation == ESimPropagation::Analytic)
+	{
+		AdaptiveReady = false;
+		MultistepReady = false;
+	}
+	else if (Settings.Integrator == ESimIntegrator::DormandPrince)
+	{
+		IntegrateAdaptive(Direction * dtSeconds, StepTime);
+		MultistepReady = false;
+	}
+	else if (Settings.Integrator == ESimIntegrator::AdamsBashforthMoulton)
+	{
+		IntegrateMultistep(Direction * dtSeconds, StepTime);
+		AdaptiveReady = false;
+	}
+	else
+	{
+		Integrate(State, Direction * dtSeconds, StepTime);
+		AdaptiveReady = false;
+		MultistepReady = false;
+	}
+
+	if (AnalyticReady)
+		AnalyticPropagator.Evaluate(State, (UpdatedTo - AnalyticEpoch).GetTotalSeconds());
+}
+
+void FSimEngine::BuildEphemeris
+(
+	const FSimStateStore& Celestial,
+	const TArray<FString>& CelestialNames,
+	double Begin,
+	double End
+)
+{
+	// integrate celestial bodies, not the old ephemeris
+	EphemerisReady = false;
+	AdaptiveReady = false;
+	MultistepReady = false;
+
+	Ephemeris.Fit(
+		Celestial, CelestialNames, UpdatedTo,
+		Begin, End,
+		Settings.EphemerisStep,
+		[this](FSimStateStore& CelestialState, double StepLength)
+		{
+			Integrate(CelestialState, StepLength, 0);
+		});
+}
+
+void FSimEngine::GetPhysicPositions
+(
+	TArray<FVector>& OutPositions
+) const
+{
+	OutPositions.Reset(State.NumPhysic + State.NumAnalytic);
+
+	for (int32 i = State.NumCelestial; i < State.Num(); ++i)
+		OutPositions.Emplace(State.Position.Get(i));
+}
+
+double FSimEngine::GetRotation
+(
+	int32 Index,
+	const FDateTime& Time
+) const
+{
+	const double Period = State.RotationPeriod[Index];
+
+	// to a fraction of a second, samples may fall between whole ones
+	return Period ? -360. * (Time - FDateTime(1970, 1, 1)).GetTotalSeconds() / Period : 0;
+}
+
+void FSimEngine::OrbitToState
+(
+	double GM, // µ
+	double SemiMajorAxis, // a
+	double Eccentricity, // e
+	double Inclination, // i
+	double LongitudeOfAscendingNode, // Ω
+	double ArgumentOfPerigee, // ω
+	double TrueAnomaly, // θ
+	FVector& OutPosition,
+	FVector& OutVelocity
+)
+{
+	Inclination = FMath::DegreesToRadians(Inclination);
+	LongitudeOfAscendingNode = FMath::DegreesToRadians(LongitudeOfAscendingNode);
+	ArgumentOfPerigee = FMath::DegreesToRadians(ArgumentOfPerigee);
+	TrueAnomaly = FMath::DegreesToRadians(TrueAnomaly);
+
+	double sini = sin(Inclination);
+	double cosi = cos(Inclination);
+
+	double sinΩ = sin(LongitudeOfAscendingNode);
+	double cosΩ = cos(LongitudeOfAscendingNode);
+
+	double sinω = sin(ArgumentOfPerigee);
+	double cosω = cos(ArgumentOfPerigee);
+
+	double sinθ = sin(TrueAnomaly);
+	double cosθ = cos(TrueAnomaly);
+
+	// Eccentric anomaly
+	double cosE = (Eccentricity + cosθ) / (1 + Eccentricity * cosθ);
+	double sinE = FMath::Sign(sinθ) * sqrt(1 - cosE * cosE);
+
+	double Distance = 1000. * SemiMajorAxis * (1 - Eccentricity * cosE);
+
+	double temp0 = sqrt(GM * 1000. * SemiMajorAxis) / Distance;
+
+	// orbital frame velocity
+	double OVx = -temp0 * sinE;
+	double OVy = temp0 * sqrt(1 - Eccentricity * Eccentricity) * cosE;
+
+	double temp11 = -cosω * cosΩ + sinω * cosi * sinΩ;
+	double temp12 = -sinω * cosΩ - cosω * cosi * sinΩ;
+	double temp21 = -cosω * sinΩ - sinω * cosi * cosΩ;
+	double temp22 = -cosω * cosi * cosΩ + sinω * sinΩ;
+	double temp31 =  sinω * sini;
+	double temp32 =  cosω * sini;
+
+	OutPosition = FVector( Distance * (cosθ * temp11 - sinθ * temp12),
+	                      -Distance * (cosθ * temp21 + sinθ * temp22),
+	                       Distance * (cosθ * temp31 + sinθ * temp32));
+
+	OutVelocity = FVector(OVx * temp11 - OVy * temp12,
+	                    -(OVx * temp21 + OVy * temp22),
+	                      OVx * temp31 + OVy * temp32);
+}
+
+inline void FSimEngine::CalculateCelestialAccelerations
+(
+	FSimStateStore& Store,
+	int32 Stage
+)
+{
+	const int32 NumC = Store.NumCelestial;
+
+	const double* PX = Store.P[Stage].X.GetData();
+	const double* PY = Store.P[Stage].Y.GetData();
+	const double* PZ = Store.P[Stage].Z.GetData();
+
+	double* AX = Store.A[Stage].X.GetData();
+	double* AY = Store.A[Stage].Y.GetData();
+	double* AZ = Store.A[Stage].Z.GetData();
+
+	// radius vector between bodies
+	double rx, ry, rz;
+	// distance between bodies
+	double norm_r;
+	// distance square
+	double r2;
+	// point mass acceleration factor
+	double k;
+
+	for (int32 i = 0; i < NumC - 1; ++i)
+	{
+		for (int32 j = i + 1; j < NumC; ++j)
+		{
+			if (Store.GM[i] == 0 && Store.GM[j] == 0)
+				continue;
+
+			rx = PX[j] - PX[i];
+			ry = PY[j] - PY[i];
+			rz = PZ[j] - PZ[i];
+			r2 = rx * rx + ry * ry + rz * rz;
+			norm_r = FMath::Sqrt(r2);
+
+			if (Store.GM[j] != 0)
+			{
+				k = Store.GM[j] / (norm_r * r2);
+				AX[i] += rx * k;
+				AY[i] += ry * k;
+				AZ[i] += rz * k;
+			}
+
+			if (Store.GM[i] != 0)
+			{
+				k = Store.GM[i] / (norm_r * r2);
+				AX[j] -= rx * k;
+				AY[j] -= ry * k;
+				AZ[j] -= rz * k;
+			}
+		}
+	}
+}
+
+inline void FSimEngine::CalculatePhysicAccelerations
+(
+	FSimStateStore& Store,
+	int32 Stage,
+	int32 Begin,
+	int32 End
+)
+{
+	const int32 NumC = Store.NumCelestial;
+
+	const double* PX = Store.P[Stage].X.GetData();
+	const double* PY = Store.P[Stage].Y.GetData();
+	const double* PZ = Store.P[Stage].Z.GetData();
+
+	double* AX = Store.A[Stage].X.GetData();
+	double* AY = Store.A[Stage].Y.GetData();
+	double* AZ = Store.A[Stage].Z.GetData();
+
+	const auto Kernel = Settings.VectorizedIntegration ? &FSimAccelerationKernel::Accumulate :
+												&FSimAccelerationKernel::AccumulateScalar;
+
+	// celestial bodies are summed in the same order for every body,
+	// so the result does not depend on how bodies are split into chunks
+	for (int32 c = 0; c < NumC; ++c)
+	{
+		if (Store.GM[c] == 0)
+			continue;
+
+		const FSimAttractor Attractor = FSimAccelerationKernel::MakeAttractor(
+			PX[c], PY[c], PZ[c],
+			Store.GM[c], Store.J2[c], Store.Radius[c]);
+
+		Kernel(Attractor, PX, PY, PZ, AX, AY, AZ, Begin, End);
+	}
+}
+
+inline void FSimEngine::IntegrationStage
+(
+	FSimStateStore& Store,
+	int32 Index,
+	double StepLength,
+	int32 Stage
+)
+{
+	const FSimVectorColumn& A = Store.A[Stage];
+	const FSimVectorColumn& V = Store.V[Stage];
+	FSimVectorColumn& NextV = Store.V[Stage + 1];
+	FSimVectorColumn& NextP = Store.P[Stage + 1];
+
+	const double h2 = StepLength * StepLength / 2;
+
+	NextV.X[Index] += StepLength * A.X[Index];
+	NextV.Y[Index] += StepLength * A.Y[Index];
+	NextV.Z[Index] += StepLength * A.Z[Index];
+
+	NextP.X[Index] += StepLength * V.X[Index] + h2 * A.X[Index];
+	NextP.Y[Index] += StepLength * V.Y[Index] + h2 * A.Y[Index];
+	NextP.Z[Index] += StepLength * V.Z[Index] + h2 * A.Z[Index];
+}
+
+void FSimEngine::IntegrationStep
+(
+	FSimStateStore& Store,
+	int32 Index,
+	double StepLength
+)
+{
+	const FSimVectorColumn* A = Store.A;
+	const FSimVectorColumn* V = Store.V;
+
+	const double h6 = StepLength / 6;
+
+	Store.Velocity.X[Index] += h6 * (A[0].X[Index] + 2 * (A[1].X[Index] + A[2].X[Index]) + A[3].X[Index]);
+	Store.Velocity.Y[Index] += h6 * (A[0].Y[Index] + 2 * (A[1].Y[Index] + A[2].Y[Index]) + A[3].Y[Index]);
+	Store.Velocity.Z[Index] += h6 * (A[0].Z[Index] + 2 * (A[1].Z[Index] + A[2].Z[Index]) + A[3].Z[Index]);
+
+	Store.Position.X[Index] += h6 * (V[0].X[Index] + 2 * (V[1].X[Index] + V[2].X[Index]) + V[3].X[Index]);
+	Store.Position.Y[Index] += h6 * (V[0].Y[Index] + 2 * (V[1].Y[Index] + V[2].Y[Index]) + V[3].Y[Index]);
+	Store.Position.Z[Index] += h6 * (V[0].Z[Index] + 2 * (V[1].Z[Index] + V[2].Z[Index]) + V[3].Z[Index]);
+}
+
+void FSimEngine::CalculateAccelerations
+(
+	FSimStateStore& Store,
+	int32 Stage,
+	bool bOnEphemeris
+)
+{
+	const int32 NumC = Store.NumCelestial;
+	const SIZE_T Bytes = Store.Num() * sizeof(double);
+
+	FSimVectorColumn& A = Store.A[Stage];
+
+	FMemory::Memzero(A.X.GetData(), Bytes);
+	FMemory::Memzero(A.Y.GetData(), Bytes);
+	FMemory::Memzero(A.Z.GetData(), Bytes);
+
+	if (bOnEphemeris)
+		A.Set(0, OriginAcceleration(Store, Stage));
+	else
+		CalculateCelestialAccelerations(Store, Stage);
+
+	// accelerations relative to origin
+	const double AX0 = A.X[0];
+	const double AY0 = A.Y[0];
+	const double AZ0 = A.Z[0];
+
+	for (int32 i = 1; i < NumC; ++i)
+	{
+		A.X[i] -= AX0;
+		A.Y[i] -= AY0;
+		A.Z[i] -= AZ0;
+	}
+
+	ForEachPhysicChunk(Store, [&](int32 Begin, int32 End)
+	{
+		CalculatePhysicAccelerations(Store, Stage, Begin, End);
+
+		for (int32 i = Begin; i < End; ++i)
+		{
+			A.X[i] -= AX0;
+			A.Y[i] -= AY0;
+			A.Z[i] -= AZ0;
+		}
+	});
+}
+
+bool FSimEngine::IsOnEphemeris
+(
+	double Time,
+	double DeltaTime
+) const
+{
+	return Settings.CelestialEphemeris &&
+		   EphemerisReady &&
+		   Ephemeris.Covers(Time) &&
+		   Ephemeris.Covers(Time + DeltaTime);
+}
+
+void FSimEngine::LoadCelestialStage
+(
+	FSimStateStore& Store,
+	int32 Stage,
+	double Time
+) const
+{
+	FVector Position, Velocity, OriginPosition, OriginVelocity;
+
+	// ephemeris may be relative to another body
+	Ephemeris.Evaluate(EphemerisBodies[0], Time, OriginPosition, OriginVelocity);
+
+	for (int32 i = 1; i < Store.NumCelestial; ++i)
+	{
+		Ephemeris.Evaluate(EphemerisBodies[i], Time, Position, Velocity);
+
+		Store.P[Stage].Set(i, Position - OriginPosition);
+		Store.V[Stage].Set(i, Velocity - OriginVelocity);
+	}
+}
+
+void FSimEngine::LoadCelestialState
+(
+	FSimStateStore& Store,
+	double Time
+) const
+{
+	FVector Position, Velocity, OriginPosition, OriginVelocity;
+
+	Ephemeris.Evaluate(EphemerisBodies[0], Time, OriginPosition, OriginVelocity);
+
+	for (int32 i = 1; i < Store.NumCelestial; ++i)
+	{
+		Ephemeris.Evaluate(EphemerisBodies[i], Time, Position, Velocity);
+
+		Store.Position.Set(i, Position - OriginPosition);
+		Store.Velocity.Set(i, Velocity - OriginVelocity);
+	}
+}
+
+FVector FSimEngine::OriginAcceleration
+(
+	const FSimStateStore& Store,
+	int32 Stage
+)
+{
+	FVector Acceleration = FVector::Zero();
+
+	for (int32 i = 1; i < Store.NumCelestial; ++i)
+	{
+		if (Store.GM[i] == 0)
+			continue;
+
+		const FVector Position = Store.P[Stage].Get(i);
+		const double r2 = Position.SizeSquared();
+
+		Acceleration += Position * (Store.GM[i] / (FMath::Sqrt(r2) * r2));
+	}
+
+	return Acceleration;
+}
+
+void FSimEngine::ForEachPhysicChunk
+(
+	const FSimStateStore& Store,
+	TFunctionRef<void(int32 Begin, int32 End)> Function
+) const
+{
+	const int32 Begin = Store.NumCelestial;
+	const int32 End = Store.NumCelestial + Store.NumPhysic;
+	const int32 ChunkSize = FMath::Max(Settings.ParallelChunkSize, 1);
+	const int32 NumChunks = FMath::DivideAndRoundUp(End - Begin, ChunkSize);
+
+	if (NumChunks <= 0)
+		return;
+
+	ParallelFor(
+		NumChunks,
+		[&](int32 Chunk)
+		{
+			const int32 ChunkBegin = Begin + Chunk * ChunkSize;
+			Function(ChunkBegin, FMath::Min(ChunkBegin + ChunkSize, End));
+		},
+		Settings.ParallelIntegration && NumChunks > 1 ? EParallelForFlags::None :
+											   EParallelForFlags::ForceSingleThread
+	);
+}
+
+inline void FSimEngine::Integrate
+(
+	FSimStateStore& Store,
+	double DeltaTime,
+	double Time
+)
+{
+	const int32 NumC = Store.NumCelestial;
+
+	if (NumC == 0)
+		return;
+
+	double h = DeltaTime / 2;
+
+	// celestial bodies are looked up at stage times instead
+	const bool bOnEphemeris = IsOnEphemeris(Time, DeltaTime);
+	const double StageTime[4] = { Time, Time + h, Time + h, Time + DeltaTime };
+
+	// set default values
+	Store.ClearBuffers();
+
+	// 4 stages of integration
+	for (int32 k = 0; k < 4; ++k)
+	{
+		FSimVectorColumn& A = Store.A[k];
+
+		if (bOnEphemeris)
+		{
+			LoadCelestialStage(Store, k, StageTime[k]);
+			A.Set(0, OriginAcceleration(Store, k));
+		}
+		else
+		{
+			// massless physic bodies do not affect celestial bodies,
+			// so they are integrated first on this thread
+			CalculateCelestialAccelerations(Store, k);
+		}
+
+		// accelerations relative to origin
+		const double AX0 = A.X[0];
+		const double AY0 = A.Y[0];
+		const double AZ0 = A.Z[0];
+
+		for (int32 i = 1; i < NumC; ++i)
+		{
+			A.X[i] -= AX0;
+			A.Y[i] -= AY0;
+			A.Z[i] -= AZ0;
+		}
+
+		if (k == 2)
+			h = DeltaTime;
+
+		if (k != 3 && !bOnEphemeris)
+		{
+			for (int32 i = 1; i < NumC; ++i)
+				IntegrationStage(Store, i, h, k);
+		}
+
+		ForEachPhysicChunk(Store, [&](int32 Begin, int32 End)
+		{
+			CalculatePhysicAccelerations(Store, k, Begin, End);
+
+			for (int32 i = Begin; i < End; ++i)
+			{
+				A.X[i] -= AX0;
+				A.Y[i] -= AY0;
+				A.Z[i] -= AZ0;
+			}
+
+			if (k == 3)
+				return;
+
+			for (int32 i = Begin; i < End; ++i)
+				IntegrationStage(Store, i, h, k);
+		});
+	}
+
+	if (bOnEphemeris)
+	{
+		LoadCelestialState(Store, Time + DeltaTime);
+	}
+	else
+	{
+		for (int32 i = 1; i < NumC; ++i)
+			IntegrationStep(Store, i, DeltaTime);
+	}
+
+	ForEachPhysicChunk(Store, [&](int32 Begin, int32 End)
+	{
+		for (int32 i = Begin; i < End; ++i)
+			IntegrationStep(Store, i, DeltaTime);
+	});
+}
+
+void FSimEngine::IntegrateAdaptive
+(
+	double DeltaTime,
+	double Time
+)
+{
+	if (!AdaptiveReady ||
+		AdaptiveIntegrator.GetDirection() != FMath::Sign(DeltaTime))
+	{
+		AdaptiveIntegrator.Settings.RelativeTolerance = Settings.RelativeTolerance;
+		AdaptiveIntegrator.Settings.PositionTolerance = Settings.PositionTolerance;
+		AdaptiveIntegrator.Settings.MaxStep = FMath::Max(Settings.MaxStep, dtSeconds);
+
+		AdaptiveIntegrator.Reset(State, DeltaTime);
+		AdaptiveTime = 0;
+		AdaptiveEpoch = Time;
+		AdaptiveReady = true;
+	}
+
+	AdaptiveTime += DeltaTime;
+
+	// celestial bodies keep fixed RK4 steps ahead of physic bodies
+	AdaptiveIntegrator.PrepareTrack(
+		AdaptiveTime,
+		[this](FSimStateStore& CelestialState, double TrackTime, double StepLength)
+		{
+			Integrate(CelestialState, StepLength, AdaptiveEpoch + TrackTime);
+		});
+
+	AdaptiveIntegrator.WriteCelestial(State, AdaptiveTime);
+
+	ForEachPhysicChunk(State, [&](int32 Begin, int32 End)
+	{
+		for (int32 i = Begin; i < End; ++i)
+			AdaptiveIntegrator.AdvanceBody(State, i, AdaptiveTime);
+	});
+}
+
+void FSimEngine::IntegrateMultistep
+(
+	double DeltaTime,
+	double Time
+)
+{
+	const int32 NumC = State.NumCelestial;
+
+	if (NumC == 0)
+		return;
+
+	// origin is not integrated
+	auto ForEachBody = [&](TFunctionRef<void(int32 Begin, int32 End)> Function)
+	{
+		Function(1, NumC);
+		ForEachPhysicChunk(State, Function);
+	};
+
+	auto PushHistory = [&]()
+	{
+		ForEachBody([&](int32 Begin, int32 End)
+		{
+			MultistepIntegrator.Push(State, Begin, End);
+		});
+
+		MultistepIntegrator.Commit();
+	};
+
+	const bool bOnEphemeris = IsOnEphemeris(Time, DeltaTime);
+
+	// history is only valid for one step length
+	// and one source of celestial bodies
+	if (!MultistepReady ||
+		MultistepStep != DeltaTime ||
+		MultistepEphemeris != bOnEphemeris)
+	{
+		MultistepIntegrator.Reset(State.Num());
+
+		State.ClearBuffer(0);
+		CalculateAccelerations(State, 0, bOnEphemeris);
+		PushHistory();
+
+		MultistepStep = DeltaTime;
+		MultistepEphemeris = bOnEphemeris;
+		MultistepReady = true;
+	}
+
+	if (MultistepIntegrator.IsStarted())
+	{
+		// celestial bodies are looked up instead of predicted
+		auto ForEachIntegrated = [&](TFunctionRef<void(int32 Begin, int32 End)> Function)
+		{
+			if (bOnEphemeris)
+				ForEachPhysicChunk(State, Function);
+			else
+				ForEachBody(Function);
+		};
+
+		ForEachIntegrated([&](int32 Begin, int32 End)
+		{
+			MultistepIntegrator.Predict(State, DeltaTime, Begin, End);
+		});
+
+		if (bOnEphemeris)
+			LoadCelestialStage(State, 0, Time + DeltaTime);
+
+		CalculateAccelerations(State, 0, bOnEphemeris);
+
+		ForEachIntegrated([&](int32 Begin, int32 End)
+		{
+			MultistepIntegrator.Correct(State, DeltaTime, Begin, End);
+		});
+
+		if (bOnEphemeris)
+			LoadCelestialState(State, Time + DeltaTime);
+
+		// accelerations of the prediction stand for the corrected state
+		if (!Settings.CorrectorEvaluation)
+		{
+			PushHistory();
+			return;
+		}
+	}
+	else
+	{
+		Integrate(State, DeltaTime, Time);
+	}
+
+	State.ClearBuffer(0);
+	CalculateAccelerations(State, 0, bOnEphemeris);
+	PushHistory();
+}
@@ -0,0 +1,253 @@
+// DHmelevcev 2025
+
+#include "SimEphemeris.h"
+#include "Dom/JsonObject.h"
+
+void FSimEphemeris::Fit
+(
+	const FSimStateStore& State,
+	const TArray<FString>& iNames,
+	const FDateTime& iEpoch,
+	double Begin,
+	double End,
+	double MaxStep,
+	TFunctionRef<void(FSimStateStore& CelestialState, double StepLength)> StepCelestial,
+	double iSegmentLength,
+	int32 iNumCoefficients
+)
+{
+	const int32 NumC = State.NumCelestial;
+	check(iNames.Num() == NumC);
+
+	Names = iNames;
+	Epoch = iEpoch;
+	StartTime = FMath::Min(Begin, 0.);
+	SegmentLength = iSegmentLength;
+	NumSegments = FMath::Max(FMath::CeilToInt32((FMath::Max(End, 0.) - StartTime) / SegmentLength), 1);
+	NumCoefficients = iNumCoefficients;
+
+	const int32 N = NumCoefficients;
+
+	// Chebyshev nodes, descending from 1 to -1
+	TArray<double> Nodes;
+	Nodes.SetNum(N);
+	for (int32 k = 0; k < N; ++k)
+		Nodes[k] = FMath::Cos(PI * (k + 0.5) / N);
+
+	auto NodeTime = [&](int32 Segment, int32 k)
+	{
+		return StartTime + SegmentLength * (Segment + (1 + Nodes[k]) / 2);
+	};
+
+	// [(segment * N + k) * NumC + body]
+	TArray<FVector> Samples;
+	Samples.SetNum(NumSegments * N * NumC);
+
+	// celestial only copy of the state
+	FSimStateStore Celestial;
+	double Time = 0;
+
+	auto Sample = [&](int32 Segment, int32 k)
+	{
+		const double Target = NodeTime(Segment, k);
+
+		while (Time != Target)
+		{
+			const double h = FMath::Clamp(Target - Time, -MaxStep, MaxStep);
+
+			StepCelestial(Celestial, h);
+			Time = FMath::Abs(Target - Time) <= MaxStep ? Target : Time + h;
+		}
+
+		for (int32 i = 0; i < NumC; ++i)
+			Samples[(Segment * N + k) * NumC + i] = Celestial.Position.Get(i);
+	};
+
+	// forward from the epoch through the nodes in ascending time
+	Celestial.CopyCelestial(State);
+	Time = 0;
+
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		for (int32 k = N - 1; k >= 0; --k)
+		{
+			if (NodeTime(Segment, k) >= 0)
+				Sample(Segment, k);
+		}
+	}
+
+	// backward through the rest
+	Celestial.CopyCelestial(State);
+	Time = 0;
+
+	for (int32 Segment = NumSegments - 1; Segment >= 0; --Segment)
+	{
+		for (int32 k = 0; k < N; ++k)
+		{
+			if (NodeTime(Segment, k) < 0)
+				Sample(Segment, k);
+		}
+	}
+
+	// discrete Chebyshev transform of the samples
+	Coefficients.SetNumZeroed(NumC * NumSegments * 3 * N);
+
+	for (int32 i = 0; i < NumC; ++i)
+	{
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			double* c = &Coefficients[(i * NumSegments + Segment) * 3 * N];
+
+			for (int32 j = 0; j < N; ++j)
+			{
+				FVector Sum = FVector::Zero();
+
+				for (int32 k = 0; k < N; ++k)
+					Sum += Samples[(Segment * N + k) * NumC + i] * FMath::Cos(PI * j * (k + 0.5) / N);
+
+				Sum *= (j == 0 ? 1. : 2.) / N;
+
+				c[j] = Sum.X;
+				c[N + j] = Sum.Y;
+				c[2 * N + j] = Sum.Z;
+			}
+		}
+	}
+}
+
+bool FSimEphemeris::Covers
+(
+	double Time
+) const
+{
+	return NumSegments > 0 &&
+	       Time >= StartTime &&
+	       Time <= StartTime + NumSegments * SegmentLength;
+}
+
+void FSimEphemeris::Evaluate
+(
+	int32 Body,
+	double Time,
+	FVector& OutPosition,
+	FVector& OutVelocity
+) const
+{
+	const double u = (Time - StartTime) / SegmentLength;
+	const int32 Segment = FMath::Clamp(FMath::FloorToInt32(u), 0, NumSegments - 1);
+	const double x = 2 * (u - Segment) - 1;
+
+	const int32 N = NumCoefficients;
+	const double* c = &Coefficients[(Body * NumSegments + Segment) * 3 * N];
+
+	double Position[3] = { c[0], c[N], c[2 * N] };
+	double Derivative[3] = { 0, 0, 0 };
+
+	// T(j) and dT(j) / dx by recurrence
+	double T0 = 1, T1 = x;
+	double D0 = 0, D1 = 1;
+
+	for (int32 j = 1; j < N; ++j)
+	{
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Position[Axis] += c[Axis * N + j] * T1;
+			Derivative[Axis] += c[Axis * N + j] * D1;
+		}
+
+		const double T2 = 2 * x * T1 - T0;
+		const double D2 = 2 * T1 + 2 * x * D1 - D0;
+
+		T0 = T1;
+		T1 = T2;
+		D0 = D1;
+		D1 = D2;
+	}
+
+	OutPosition = FVector(Position[0], Position[1], Position[2]);
+	OutVelocity = FVector(Derivative[0], Derivative[1], Derivative[2]) * (2 / SegmentLength);
+}
+
+TSharedRef<FJsonObject> FSimEphemeris::ToJson() const
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+
+	Json->SetStringField("Epoch", Epoch.ToIso8601());
+	Json->SetNumberField("StartTime", StartTime);
+	Json->SetNumberField("SegmentLength", SegmentLength);
+	Json->SetNumberField("NumSegments", NumSegments);
+	Json->SetNumberField("NumCoefficients", NumCoefficients);
+
+	const int32 PerBody = NumSegments * 3 * NumCoefficients;
+
+	TArray<TSharedPtr<FJsonValue>> Bodies;
+
+	for (int32 i = 0; i < Names.Num(); ++i)
+	{
+		TSharedRef<FJsonObject> Body = MakeShared<FJsonObject>();
+		Body->SetStringField("Name", Names[i]);
+
+		TArray<TSharedPtr<FJsonValue>> Values;
+		Values.Reserve(PerBody);
+
+		for (int32 j = 0; j < PerBody; ++j)
+			Values.Emplace(MakeShared<FJsonValueNumber>(Coefficients[i * PerBody + j]));
+
+		Body->SetArrayField("Coefficients", Values);
+		Bodies.Emplace(MakeShared<FJsonValueObject>(Body));
+	}
+
+	Json->SetArrayField("Bodies", Bodies);
+
+	return Json;
+}
+
+bool FSimEphemeris::FromJson
+(
+	const FJsonObject& Json
+)
+{
+	FString EpochString;
+	const TArray<TSharedPtr<FJsonValue>>* Bodies;
+
+	if (!Json.TryGetStringField("Epoch", EpochString) ||
+		!FDateTime::ParseIso8601(*EpochString, Epoch) ||
+		!Json.TryGetNumberField("StartTime", StartTime) ||
+		!Json.TryGetNumberField("SegmentLength", SegmentLength) ||
+		!Json.TryGetNumberField("NumSegments", NumSegments) ||
+		!Json.TryGetNumberField("NumCoefficients", NumCoefficients) ||
+		!Json.TryGetArrayField("Bodies", Bodies) ||
+		SegmentLength <= 0 || NumSegments <= 0 || NumCoefficients <= 0)
+	{
+		Names.Reset();
+		return false;
+	}
+
+	const int32 PerBody = NumSegments * 3 * NumCoefficients;
+
+	Names.Reset();
+	Coefficients.Reset();
+
+	for (const auto& Value : *Bodies)
+	{
+		const TSharedPtr<FJsonObject>* Body;
+		FString Name;
+		const TArray<TSharedPtr<FJsonValue>>* Values;
+
+		if (!Value->TryGetObject(Body) ||
+			!(*Body)->TryGetStringField("Name", Name) ||
+			!(*Body)->TryGetArrayField("Coefficients", Values) ||
+			Values->Num() != PerBody)
+		{
+			Names.Reset();
+			return false;
+		}
+
+		Names.Emplace(Name);
+
+		for (const auto& Coefficient : *Values)
+			Coefficients.Emplace(Coefficient->AsNumber());
+	}
+
+	return true;
+}
@@ -3,9 +3,13 @@
 #include "SimFileManager.h"
 #include "SimGameMode.h"
 #include "SimCelestialBody.h"
+#include "SimEphemeris.h"
+#include "SimCoverage.h"
+#include "SimAccessWindows.h"
 #include "Developer/DesktopPlatform/Public/IDesktopPlatform.h"
 #include "Developer/DesktopPlatform/Public/DesktopPlatformModule.h"
 #include "Serialization/JsonSerializer.h"
+#include "HAL/FileManager.h"
 #include "Components/ListView.h"
 
 void USimFileManager::OpenFileDialog(const FString& DialogTitle,
@@ -42,33 +46,30 @@ FString USimFileManager::ReadStringFromFile(const FString& File) {
 void USimFileManager::ImportSatelitteDataFromFile(const FString& File,
 	                                              ASimGameMode* GameMode,
 	                                              UListView* ListView) {
-	FString jsonString = USimFileManager::ReadStringFromFile(File);
-	TSharedPtr<FJsonObject> json = USimFileManager::ReadJsonFromString(jsonString);
-	if (!json)
+	FSimScenario scenario;
+	FSimEngineSettings settings = GameMode->GetEngineSettings();
+	if (!USimFileManager::ReadScenario(File, scenario, settings))
 		return;
 
-	const auto& array = json->GetArrayField("Satellites");
-
-	for (const auto& satellite : array) {
-		const auto& satelliteData = satellite->AsObject();
+	GameMode->SetEngineSettings(settings);
 
-		FString name = satelliteData->GetStringField("Name");
-		FString bodyName = satelliteData->GetStringField("Body");
-		double semiMajorAxis = satelliteData->GetNumberField("SemiMajorAxis");
-		double eccentricity = satelliteData->GetNumberField("Eccentricity");
-		double inclination = satelliteData->GetNumberField("Inclination");
-		double longitudeOfAscendingNode = satelliteData->GetNumberField("LongitudeOfAscendingNode");
-		double argumentOfPerigee = satelliteData->GetNumberField("ArgumentOfPerigee");
-		double trueAnomaly = satelliteData->GetNumberField("TrueAnomaly");
+	if (!scenario.Ephemeris.IsEmpty() && !GameMode->LoadEphemeris(scenario.Ephemeris))
+		UE_LOG(LogTemp, Warning, TEXT("Can not load ephemeris %s"), *scenario.Ephemeris);
 
-		ASimCelestialBody** body = GameMode->CelestialBodies.FindByPredicate([&bodyName](const auto& body) {
-			return body->BodyName == bodyName;
+	// celestial bodies of the level are used
+	for (const auto& satellite : scenario.Satellites) {
+		ASimCelestialBody** body = GameMode->CelestialBodies.FindByPredicate([&satellite](const auto& body) {
+			return body->BodyName == satellite.Body;
 		});
 		if (!body || !*body)
 			continue;
 
-		ASimBody* newBody = GameMode->SpawnBody(name, *body,
-			                                    semiMajorAxis, eccentricity, inclination, longitudeOfAscendingNode, argumentOfPerigee, trueAnomaly);
+		ASimBody* newBody = GameMode->SpawnBody(satellite.Name, *body,
+			                                    satellite.SemiMajorAxis, satellite.Eccentricity, satellite.Inclination,
+			                                    satellite.LongitudeOfAscendingNode, satellite.ArgumentOfPerigee, satellite.TrueAnomaly);
+
+		if (newBody && satellite.Propagation.IsSet())
+			GameMode->SetBodyPropagation(newBody, satellite.Propagation.GetValue());
 
 		if (newBody && ListView)
 			ListView->AddItem(newBody);
@@ -77,27 +78,134 @@ void USimFileManager::ImportSatelitteDataFromFile(const FString& File,
 	return;
 }
 
+bool USimFileManager::ReadScenario(const FString& File,
+                                   FSimScenario& OutScenario,
+                                   FSimEngineSettings& InOutSettings) {
+	FString jsonString = USimFileManager::ReadStringFromFile(File);
+	TSharedPtr<FJsonObject> json = USimFileManager::ReadJsonFromString(jsonString);
+	if (!json)
+		return false;
+
+	// optional integration settings of the scenario
+	const TSharedPtr<FJsonObject>* integrator;
+	if (json->TryGetObjectField("Integrator", integrator)) {
+		FString method;
+		if ((*integrator)->TryGetStringField("Method", method)) {
+			int64 value = StaticEnum<ESimIntegrator>()->GetValueByNameString(method);
+			if (value != INDEX_NONE)
+				InOutSettings.Integrator = static_cast<ESimIntegrator>(value);
+		}
+
+		(*integrator)->TryGetNumberField("RelativeTolerance", InOutSettings.RelativeTolerance);
+		(*integrator)->TryGetNumberField("PositionTolerance", InOutSettings.PositionTolerance);
+		(*integrator)->TryGetNumberField("MaxStep", InOutSettings.MaxStep);
+		(*integrator)->TryGetBoolField("CorrectorEvaluation", InOutSettings.CorrectorEvaluation);
+	}
+
+	// optional celestial ephemeris, relative to the scenario file
+	OutScenario.Ephemeris.Reset();
+	if (json->TryGetStringField("Ephemeris", OutScenario.Ephemeris)) {
+		if (FPaths::IsRelative(OutScenario.Ephemeris))
+			OutScenario.Ephemeris = FPaths::Combine(FPaths::GetPath(File), OutScenario.Ephemeris);
+	}
+
+	FString propagation;
+	if (json->TryGetStringField("Propagation", propagation)) {
+		int64 value = StaticEnum<ESimPropagation>()->GetValueByNameString(propagation);
+		if (value != INDEX_NONE)
+			InOutSettings.Propagation = static_cast<ESimPropagation>(value);
+	}
+
+	auto readVector = [](const FJsonObject& object, const FString& field, FVector& vector) {
+		const TArray<TSharedPtr<FJsonValue>>* components;
+		if (object.TryGetArrayField(field, components) && components->Num() == 3)
+			vector = FVector((*components)[0]->AsNumber(), (*components)[1]->AsNumber(), (*components)[2]->AsNumber());
+	};
+
+	// optional celestial bodies for runs without a level
+	OutScenario.CelestialBodies.Reset();
+	const TArray<TSharedPtr<FJsonValue>>* bodies;
+	if (json->TryGetArrayField("CelestialBodies", bodies)) {
+		for (const auto& body : *bodies) {
+			const auto& bodyData = body->AsObject();
+			FSimScenarioBody& newBody = OutScenario.CelestialBodies.Emplace_GetRef();
+
+			newBody.Name = bodyData->GetStringField("Name");
+			newBody.GM = bodyData->GetNumberField("GM");
+			bodyData->TryGetNumberField("J2", newBody.J2);
+			newBody.Radius = bodyData->GetNumberField("Radius");
+			bodyData->TryGetNumberField("SiderealRotationPeriod", newBody.SiderealRotationPeriod);
+			readVector(*bodyData, "Position", newBody.Position);
+			readVector(*bodyData, "Velocity", newBody.Velocity);
+		}
+	}
+
+	OutScenario.Satellites.Reset();
+	const TArray<TSharedPtr<FJsonValue>>* satellites;
+	if (json->TryGetArrayField("Satellites", satellites)) {
+		for (const auto& satellite : *satellites) {
+			const auto& satelliteData = satellite->AsObject();
+			FSimScenarioSatellite& newSatellite = OutScenario.Satellites.Emplace_GetRef();
+
+			newSatellite.Name = satelliteData->GetStringField("Name");
+			newSatellite.Body = satelliteData->GetStringField("Body");
+			newSatellite.SemiMajorAxis = satelliteData->GetNumberField("SemiMajorAxis");
+			newSatellite.Eccentricity = satelliteData->GetNumberField("Eccentricity");
+			newSatellite.Inclination = satelliteData->GetNumberField("Inclination");
+			newSatellite.LongitudeOfAscendingNode = satelliteData->GetNumberField("LongitudeOfAscendingNode");
+			newSatellite.ArgumentOfPerigee = satelliteData->GetNumberField("ArgumentOfPerigee");
+			newSatellite.TrueAnomaly = satelliteData->GetNumberField("TrueAnomaly");
+
+			if (satelliteData->TryGetStringField("Propagation", propagation)) {
+				int64 value = StaticEnum<ESimPropagation>()->GetValueByNameString(propagation);
+				if (value != INDEX_NONE)
+					newSatellite.Propagation = static_cast<ESimPropagation>(value);
+			}
+		}
+	}
+
+	// optional ground stations for access windows of runs without a level
+	OutScenario.Stations.Reset();
+	const TArray<TSharedPtr<FJsonValue>>* stations;
+	if (json->TryGetArrayField("Stations", stations)) {
+		for (const auto& station : *stations) {
+			const auto& stationData = station->AsObject();
+			FSimScenarioStation& newStation = OutScenario.Stations.Emplace_GetRef();
+
+			newStation.Name = stationData->GetStringField("Name");
+			newStation.Body = stationData->GetStringField("Body");
+			newStation.Latitude = stationData->GetNumberField("Latitude");
+			newStation.Longitude = stationData->GetNumberField("Longitude");
+		}
+	}
+
+	return true;
+}
+
 TSharedPtr<FJsonObject> USimFileManager::ReadJsonFromString(const FString& JsonString) {
 	TSharedPtr<FJsonObject> jsonObject;
 	bool result = FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JsonString), jsonObject);
 	return result ? jsonObject : nullptr;
 }
 
-void USimFileManager::SaveCoverageData(const TArray<double>& iData) {
+bool USimFileManager::SaveCoverageData(const TArray<double>& iData, int32 iWidth, int32 iHeight, const FString& File) {
 	TArray<uint8> ByteArray;
 	FMemoryWriter Writer(ByteArray);
 
+	// bitmap rows are padded to 4 bytes
+	uint32 stride = (iWidth + 3) & ~3;
+
 	uint16 signature = 'MB';
-	uint32 totalSize = 14 + 40 + 1024 + 180 * 360;
+	uint32 totalSize = 14 + 40 + 1024 + stride * iHeight;
 	uint32 unused = 0;
 	uint32 dataOffset = 14 + 40 + 1024;
 	uint32 infoSize = 40;
-	uint32 width = 360;
-	uint32 height = 180;
+	uint32 width = iWidth;
+	uint32 height = iHeight;
 	uint16 planes = 1;
 	uint16 bitCount = 8;
 	uint32 compression = 0;
-	uint32 imageSize = 180 * 360;
+	uint32 imageSize = stride * iHeight;
 	Writer << signature << totalSize << unused << dataOffset;
 	Writer << infoSize << width << height << planes << bitCount << compression << imageSize << unused << unused << unused << unused;
 
@@ -128,12 +236,107 @@ void USimFileManager::SaveCoverageData(const TArray<double>& iData) {
 		Writer << color;
 	}
 
-	for (int16 j = 0; j < 180; ++j) {
-		for (int16 i = 0; i < 360; ++i) {
-			uint8 ByteValue = static_cast<uint8>(iData[j * 360 + i]);
+	for (int32 j = 0; j < iHeight; ++j) {
+		for (uint32 i = 0; i < stride; ++i) {
+			uint8 ByteValue = i < width ? static_cast<uint8>(iData[j * iWidth + i]) : 0;
 			Writer << ByteValue;
 		}
 	}
 
-	FFileHelper::SaveArrayToFile(ByteArray, *(FPaths::ProjectSavedDir() + "\\log.bmp"));
+	return FFileHelper::SaveArrayToFile(ByteArray, *File);
+}
+
+bool USimFileManager::SaveCoverageStatistics(const FSimCoverage& Coverage, const FString& File) {
+	TUniquePtr<FArchive> writer(IFileManager::Get().CreateFileWriter(*File));
+	if (!writer)
+		return false;
+
+	const TArray<int32>& folds = Coverage.GetFolds();
+
+	TArray<TArray<double>> columns;
+	columns.Emplace(Coverage.GetAverage());
+	columns.Emplace(Coverage.GetMinimum());
+	columns.Emplace(Coverage.GetMaximum());
+	for (int32 f = 0; f < folds.Num(); ++f)
+		columns.Emplace(Coverage.GetFoldFraction(f));
+	columns.Emplace(Coverage.GetLongestOutage());
+	columns.Emplace(Coverage.GetMeanRevisit());
+
+	FString line = TEXT("Latitude,Longitude,Mean,Min,Max");
+	for (int32 fold : folds)
+		line += FString::Printf(TEXT(",AtLeast%d"), fold);
+	line += TEXT(",LongestOutage,MeanRevisit\n");
+
+	// a row of cells at a time, the file may hold millions of them
+	for (int32 j = 0; j < Coverage.GetNumRows(); ++j) {
+		const double latitude = Coverage.GetRowLatitude(j);
+
+		for (int32 i = 0; i < Coverage.GetRowNum(j); ++i) {
+			const int32 cell = Coverage.GetRowOffset(j) + i;
+
+			line += FString::Printf(TEXT("%.4f,%.4f"), latitude, Coverage.GetCellLongitude(j, i));
+			for (const auto& column : columns)
+				line += FString::Printf(TEXT(",%g"), column[cell]);
+			line += TEXT("\n");
+		}
+
+		auto ansi = StringCast<ANSICHAR>(*line, line.Len());
+		writer->Serialize(const_cast<ANSICHAR*>(ansi.Get()), ansi.Length());
+		line.Reset();
+	}
+
+	return writer->Close();
+}
+
+bool USimFileManager::SaveAccessWindows(const TArray<FSimAccessWindow>& Windows,
+                                        const FDateTime& Start,
+                                        const TArray<FString>& StationNames,
+                                        const TArray<FString>& SatelliteNames,
+                                        const FString& File) {
+	TUniquePtr<FArchive> writer(IFileManager::Get().CreateFileWriter(*File));
+	if (!writer)
+		return false;
+
+	auto toTime = [&Start](double seconds) {
+		return (Start + FTimespan::FromSeconds(seconds)).ToIso8601();
+	};
+
+	FString line = TEXT("Station,Satellite,Rise,Set,Duration,Culmination,MaxElevation\n");
+
+	for (int32 i = 0; i < Windows.Num(); ++i) {
+		const FSimAccessWindow& window = Windows[i];
+
+		line += FString::Printf(TEXT("%s,%s,%s,%s,%.3f,%s,%.3f\n"),
+		                        StationNames.IsValidIndex(window.Station) ? *StationNames[window.Station] : TEXT(""),
+		                        SatelliteNames.IsValidIndex(window.Satellite) ? *SatelliteNames[window.Satellite] : TEXT(""),
+		                        *toTime(window.Rise), *toTime(window.Set), window.GetDuration(),
+		                        *toTime(window.Culmination), window.MaxElevation);
+
+		// a thousand windows at a time, a week of a constellation has millions
+		if (i % 1000 == 999 || i == Windows.Num() - 1) {
+			auto ansi = StringCast<ANSICHAR>(*line, line.Len());
+			writer->Serialize(const_cast<ANSICHAR*>(ansi.Get()), ansi.Length());
+			line.Reset();
+		}
+	}
+
+	if (Windows.IsEmpty()) {
+		auto ansi = StringCast<ANSICHAR>(*line, line.Len());
+		writer->Serialize(const_cast<ANSICHAR*>(ansi.Get()), ansi.Length());
+	}
+
+	return writer->Close();
+}
+
+bool USimFileManager::SaveEphemeris(const FSimEphemeris& Ephemeris, const FString& File) {
+	FString jsonString;
+	if (!FJsonSerializer::Serialize(Ephemeris.ToJson(), TJsonWriterFactory<>::Create(&jsonString)))
+		return false;
+
+	return FFileHelper::SaveStringToFile(jsonString, *File);
+}
+
+bool USimFileManager::LoadEphemeris(FSimEphemeris& Ephemeris, const FString& File) {
+	TSharedPtr<FJsonObject> json = USimFileManager::ReadJsonFromString(USimFileManager::ReadStringFromFile(File));
+	return json && Ephemeris.FromJson(*json);
 }
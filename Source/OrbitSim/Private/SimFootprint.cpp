@@ -0,0 +1,106 @@
+// DHmelevcev 2025
+
+#include "SimFootprint.h"
+
+bool FSimFootprint::Set
+(
+	const FVector& iPosition,
+	double iRadius
+)
+{
+	Position = iPosition;
+	Radius = iRadius * 1e3;
+
+	const double r = Position.Size();
+
+	// never above the horizon
+	if (r <= Radius)
+		return false;
+
+	const double CosMask = FMath::Sqrt(1 - SinElevationMask * SinElevationMask);
+	const double Mask = FMath::Asin(SinElevationMask);
+
+	// central angle from the subsatellite point to the edge
+	// of the cap where elevation equals the mask
+	const double Cap = FMath::Acos(Radius / r * CosMask) - Mask;
+
+	Distance2 = r * r + Radius * Radius;
+
+	SinLatitude = Position.Z / r;
+	CosLatitude = FMath::Sqrt(FMath::Max(1 - SinLatitude * SinLatitude, 0.));
+
+	CapDegrees = FMath::RadiansToDegrees(Cap);
+	CosCap = FMath::Cos(Cap);
+
+	// longitude L points to -(L + 180) deg. in body-fixed coordinates
+	Column = 360 - FMath::RadiansToDegrees(FMath::Atan2(Position.Y, Position.X));
+
+	return true;
+}
+
+void FSimFootprint::GetRows
+(
+	double Height,
+	int32 NumRows,
+	int32& OutFirst,
+	int32& OutLast
+) const
+{
+	const double Colatitude = 90 - FMath::RadiansToDegrees(FMath::Asin(SinLatitude));
+
+	// with some slack for rounding at the cap edge
+	OutFirst = FMath::Max(FMath::FloorToInt32((Colatitude - CapDegrees - 1e-9) / Height), 0);
+	OutLast = FMath::Min(FMath::FloorToInt32((Colatitude + CapDegrees + 1e-9) / Height), NumRows - 1);
+}
+
+double FSimFootprint::GetWidestLatitude
+(
+	double Bottom,
+	double Top
+) const
+{
+	// the cap spans most longitude where sin(lat) = sin(lat_s) / cos(cap)
+	const double Widest = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(SinLatitude / CosCap, -1., 1.)));
+
+	return FMath::Clamp(Widest, Bottom, Top);
+}
+
+bool FSimFootprint::GetColumns
+(
+	double SinRow,
+	double CosRow,
+	double Width,
+	int32 Num,
+	int32& OutFirst,
+	int32& OutLast
+) const
+{
+	// cos of the central angle to a point of the row is
+	// sin(lat) sin(lat_s) + cos(lat) cos(lat_s) cos(dlon)
+	const double Numerator = CosCap - SinRow * SinLatitude;
+	const double Denominator = CosRow * CosLatitude;
+
+	// with some slack for rounding at the cap edge
+	if (Numerator > Denominator + 1e-9)
+		return false;
+
+	OutFirst = 0;
+	OutLast = Num - 1;
+
+	// the whole row is inside or the row is at a pole
+	if (Numerator <= -Denominator || Denominator <= 0)
+		return true;
+
+	const double HalfWidth = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Numerator / Denominator, -1., 1.)));
+
+	const int32 First = FMath::FloorToInt32((Column - HalfWidth) / Width);
+	const int32 Last = FMath::FloorToInt32((Column + HalfWidth) / Width);
+
+	if (Last - First < Num)
+	{
+		OutFirst = First;
+		OutLast = Last;
+	}
+
+	return true;
+}
@@ -1,8 +1,7 @@
 ﻿// DHmelevcev 2024
 
 #include "SimGameMode.h"
-#include <condition_variable>
-#include <mutex>
+#include "HAL/PlatformProcess.h"
 #include "Kismet/GameplayStatics.h"
 #include "SimBody.h"
 #include "SimCelestialBody.h"
@@ -10,14 +9,13 @@
 #include "SimSignalHandler.h"
 #include "SimBaseStation.h"
 #include "SimFileManager.h"
-
-std::mutex m;
-std::condition_variable cv;
-bool logReady = false;
+#include "SimAccessWindows.h"
+#include "SimCoverage.h"
+#include "SimCoverageCube.h"
+#include "SimPhysicsThread.h"
 
 ASimGameMode::ASimGameMode() :
-    UpdatedTo(FDateTime::FromUnixTimestamp(0)),
-    WorldTime(UpdatedTo),
+    WorldTime(FDateTime::FromUnixTimestamp(0)),
     TimeDilation(1)
 {
     PrimaryActorTick.bStartWithTickEnabled = true;
@@ -69,80 +67,84 @@ void ASimGameMode::BeginPlay()
             world, ASimSignalHandler::StaticClass()));
 
     if (SignalHandler != nullptr)
-        SignalHandler->SetContext(PhysicBodies, CelestialBodies, BaseStations);
+        SignalHandler->SetContext(PhysicBodies, CelestialBodies, BaseStations, WorldTime);
 
     SetOrigin(CelestialBodies[0]);
+
+    LogSamples = MakeShared<TSimSpscRing<FSimCoverageSample>, ESPMode::ThreadSafe>(LogBufferSize);
+
+    PhysicsThread = MakeUnique<FSimPhysicsThread>(this, SimulationThread);
 }
 
-void LogThread(ASimGameMode* GameMode, FDateTime EndLogTime) {
-    FDateTime LastLogged = 0;
-    TArray<FVector> LoggingPotitions;
-    TArray<double> Values;
-    Values.SetNum(180 * 360);
-    uint32 counter = 0;
+void ASimGameMode::EndPlay
+(
+    const EEndPlayReason::Type EndPlayReason
+)
+{
+    PhysicsThread.Reset();
 
-    while (true) {
-        std::unique_lock lk(m);
-        cv.wait(lk, [] { return logReady; });
-
-        double PassedTime = (GameMode->UpdatedTo - LastLogged).GetTotalSeconds();
-        if ((EndLogTime - LastLogged).GetTotalSeconds() <= 0) {
-            logReady = false;
-            lk.unlock();
-            cv.notify_all();
-            break;
-        }
-        if (PassedTime < 29) {
-            logReady = false;
-            lk.unlock();
-            cv.notify_all();
-            continue;
-        }
+    // a running log stops without saving
+    LogSamples.Reset();
 
-        LoggingPotitions.Reset();
-        for (int32 i = 0; i < GameMode->PhysicBodies.Num(); ++i)
-            LoggingPotitions.Emplace(GameMode->PhysicBodies[i]->Position);
+    Super::EndPlay(EndPlayReason);
+}
 
-        LastLogged = GameMode->UpdatedTo;
+// returns false when the game ended before EndLogTime
+bool LogThread(const TSharedPtr<TSimSpscRing<FSimCoverageSample>, ESPMode::ThreadSafe>& Samples,
+               int32 Session,
+               FDateTime EndLogTime,
+               ESimCoverageGrid Grid,
+               double Resolution,
+               const TArray<int32>& Folds,
+               bool WriteCube) {
+    FSimCoverage Coverage(Grid, Resolution, Folds);
+
+    // an unfinished cube is still readable up to its last sample
+    FSimCoverageCubeWriter cube;
+    if (WriteCube && !cube.Open(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("log.cube")), Coverage))
+        UE_LOG(LogTemp, Warning, TEXT("Can not write coverage cube"));
 
-        logReady = false;
-        lk.unlock();
-        cv.notify_all();
+    while (true) {
+        const FSimCoverageSample* Sample = Samples->Peek();
 
-        const ASimCelestialBody& CelestialBody = *(GameMode->CelestialBodies)[0];
-        FRotator Rotation = CelestialBody.StaticMesh->GetRelativeRotation();
+        if (Sample == nullptr) {
+            // game mode released the ring, nothing more will come
+            if (Samples.IsUnique())
+                return false;
 
-        for (int16 j = 0; j < 180; ++j) {
-            for (int16 i = 0; i < 360; ++i) {
-                double Longitude = i - 179.5;
-                double Latitude = 89.5 - j;
+            FPlatformProcess::SleepNoStats(0.001f);
+            continue;
+        }
 
-                FVector o = FRotator(Rotation.Pitch + Latitude,
-                                     Rotation.Yaw + 180 - Longitude,
-                                     0)
-                                    .Vector() * CelestialBody.Radius * 1e3;
+        // left over from an earlier log
+        if (Sample->Session != Session) {
+            Samples->Pop();
+            continue;
+        }
 
-                for (const auto PhysicBody : GameMode->PhysicBodies) {
-                    FVector r = PhysicBody->Position - o;
-                    r.Normalize();
-                    if (r.Dot(o.GetUnsafeNormal()) >= 0.087155742) // arcsin(5deg)
-                        ++Values[j * 360 + i];
-                }
-            }
+        if ((EndLogTime - Sample->Time).GetTotalSeconds() <= 0) {
+            Samples->Pop();
+            break;
         }
 
-        ++counter;
+        Coverage.Accumulate(Sample->Time, Sample->Positions, Sample->Radius, Sample->Rotation,
+                            cube.AddSample(Sample->Time));
+        Samples->Pop();
     }
 
-    for (auto& value : Values) {
-        value /= counter;
-    }
+    int32 width, height;
+    const TArray<double> image = Coverage.Render(Coverage.GetAverage(), width, height);
+
+    cube.Close();
+
+    USimFileManager::SaveCoverageData(image, width, height, FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("log.bmp")));
+    USimFileManager::SaveCoverageStatistics(Coverage, FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("log.csv")));
 
-    USimFileManager::SaveCoverageData(Values);
+    return true;
 }
 
 void ASimGameMode::StartLog() {
-    if (this->LogEnabled)
+    if (this->LogEnabled || !LogSamples)
         return;
 
     FTimespan maxLifetime = 0;
@@ -152,11 +154,28 @@ void ASimGameMode::StartLog() {
             maxLifetime = lifetime;
     }
 
-    AsyncTask(ENamedThreads::AnyThread, [this, maxLifetime]() {
-        this->LogEnabled = true;
-        LogThread(this, this->WorldTime + 2 * maxLifetime);
-        this->LogEnabled = false;
-        cv.notify_all();
+    const int32 session = ++LogSession;
+    LogDropped = 0;
+    this->LogEnabled = true;
+
+    TWeakObjectPtr<ASimGameMode> weakThis(this);
+    auto samples = LogSamples;
+    FDateTime endLogTime = this->WorldTime + 2 * maxLifetime;
+    ESimCoverageGrid grid = CoverageGrid;
+    double resolution = CoverageResolution;
+    TArray<int32> folds = CoverageFolds;
+    bool writeCube = CoverageCube;
+
+    AsyncTask(ENamedThreads::AnyThread, [weakThis, samples, session, endLogTime, grid, resolution, folds, writeCube]() {
+        if (!LogThread(samples, session, endLogTime, grid, resolution, folds, writeCube))
+            return;
+
+        if (ASimGameMode* gameMode = weakThis.Get()) {
+            if (gameMode->LogDropped > 0)
+                UE_LOG(LogTemp, Warning, TEXT("Coverage log dropped %d samples"), gameMode->LogDropped.load());
+
+            gameMode->LogEnabled = false;
+        }
     });
 }
 
@@ -165,25 +184,53 @@ void ASimGameMode::Tick
     float DeltaTime
 )
 {
-    WorldTime += FTimespan::FromSeconds(DeltaTime * TimeDilation);
-    int32 sim_time_direction = FMath::Sign((WorldTime - UpdatedTo).GetTicks());
+    if (Jumping)
+    {
+        // follow physics as fast as it goes
+        for (int32 i = 0; const FSimSnapshot* Snapshot = PhysicsThread->Snapshots.Peek(i); ++i)
+            WorldTime = Snapshot->Time;
+    }
+    else
+    {
+        WorldTime += FTimespan::FromSeconds(DeltaTime * TimeDilation);
+    }
 
-    while (UpdatedTo + dt < WorldTime || UpdatedTo > WorldTime)
+    // snapshots ahead in the old direction are useless
+    const int32 Direction = Jumping ? JumpDirection : FMath::Sign(TimeDilation);
+    if (Direction != 0 && Direction != SimDirection)
     {
-        std::unique_lock lk(m);
-        cv.wait(lk, [this] { return !logReady || !LogEnabled; });
+        PauseSimulation();
+        SimDirection = Direction;
+    }
 
-        UpdatedTo += sim_time_direction * dt;
+    PostStepSettings();
 
-        Integrate(sim_time_direction * dtSeconds);
+    if (StateDirty)
+        ResetSimulation();
 
-        logReady = true;
-        lk.unlock();
-        cv.notify_all();
+    if (Jumping)
+    {
+        // about a hundred progress updates per jump
+        PhysicsThread->SetTarget(
+            JumpTarget,
+            FMath::Max(dt, (JumpTarget - JumpStart).GetDuration() / 100));
+    }
+    else
+    {
+        const double LeadSeconds = FMath::Abs(TimeDilation) * SimulationLead;
 
-        UpdateTrajectoryLines();
+        PhysicsThread->SetTarget(
+            WorldTime + SimDirection * FMath::Max(dt, FTimespan::FromSeconds(LeadSeconds)),
+            FMath::Max(dt, FTimespan::FromSeconds(LeadSeconds / 4)));
     }
 
+    PhysicsThread->Pump(PhysicsBudget / 1000);
+
+    ApplySnapshots();
+
+    if (Jumping)
+        UpdateJump();
+
     for (const auto& c_body : CelestialBodies)
     {
         c_body->SetActorLocation(c_body->Position * 100);
@@ -210,6 +257,8 @@ void ASimGameMode::Tick
             if ((PhysicBodies[i]->Position - c_body->Position)
                 .Size() < c_body->Radius * 1000)
             {
+                PauseSimulation();
+
                 std::swap(
                     PhysicBodies[i],
                     PhysicBodies[NumP - destroyed_bodies - 1]
@@ -232,6 +281,402 @@ void ASimGameMode::Tick
         TrajectoriesHandler->Update(PassedTime);
 }
 
+void ASimGameMode::PauseSimulation()
+{
+    if (!PhysicsThread || PhysicsThread->IsPaused())
+        return;
+
+    PhysicsThread->Pause();
+
+    // State and actors continue from the shown snapshot
+    if (const FSimSnapshot* Shown = PhysicsThread->Snapshots.Peek())
+    {
+        Shown->Read(Engine.State);
+        Engine.State.Scatter(CelestialBodies, PhysicBodies);
+
+        Engine.UpdatedTo = Shown->Time;
+        WorldTime = Engine.UpdatedTo;
+    }
+
+    StateDirty = true;
+}
+
+void ASimGameMode::ResetSimulation()
+{
+    PauseSimulation();
+
+    PostStepSettings();
+    TakeStepSettings();
+
+    Engine.State.Gather(CelestialBodies, PhysicBodies, PartitionPhysicBodies());
+    StateDirty = false;
+
+    TArray<FString> Names;
+    for (const auto& c_body : CelestialBodies)
+        Names.Emplace(c_body->BodyName);
+
+    Engine.Reset(Names);
+
+    // the game thread is the only producer until Resume
+    PhysicsThread->Snapshots.Reset();
+    PhysicsThread->Publish();
+    PhysicsThread->Resume(SimDirection);
+}
+
+void ASimGameMode::PostStepSettings()
+{
+    FSimStepSettings Settings;
+    Settings.Engine = GetEngineSettings();
+    Settings.LogSampleInterval = LogSampleInterval;
+    Settings.LogBackpressure = LogBackpressure;
+
+    FScopeLock Lock(&StepSettingsLock);
+    PostedStepSettings = Settings;
+    StepSettingsPosted.store(true, std::memory_order_release);
+}
+
+void ASimGameMode::TakeStepSettings()
+{
+    if (!StepSettingsPosted.exchange(false, std::memory_order_acquire))
+        return;
+
+    {
+        FScopeLock Lock(&StepSettingsLock);
+        StepSettings = PostedStepSettings;
+    }
+
+    Engine.Settings = StepSettings.Engine;
+}
+
+void ASimGameMode::ApplySnapshots()
+{
+    auto& Snapshots = PhysicsThread->Snapshots;
+
+    const FSimSnapshot* A = Snapshots.Peek();
+    if (A == nullptr)
+        return;
+
+    // keep the last snapshot WorldTime has reached,
+    // it stays shown when physics falls behind
+    while (const FSimSnapshot* B = Snapshots.Peek(1))
+    {
+        if (SimDirection * (WorldTime - B->Time).GetTicks() < 0)
+            break;
+
+        Snapshots.Pop();
+        A = B;
+
+        UpdateTrajectoryLines(*A);
+    }
+
+    const FSimSnapshot* B = Snapshots.Peek(1);
+    double Alpha = 0;
+
+    // physics stops up to dt short of WorldTime when going forward
+    const double Behind = SimDirection * (WorldTime - A->Time).GetTotalSeconds();
+    SimLag = B == nullptr && Behind > dtSeconds ? Behind : 0;
+
+    if (B != nullptr)
+    {
+        const double Interval = (B->Time - A->Time).GetTotalSeconds();
+
+        if (FMath::Abs(Interval) <= MaxInterpolationInterval)
+            Alpha = FMath::Clamp((WorldTime - A->Time).GetTotalSeconds() / Interval, 0., 1.);
+    }
+
+    auto Apply = [&](ASimBody& body, int32 Index) -> void
+    {
+        if (Alpha > 0)
+        {
+            FSimSnapshot::Interpolate(*A, *B, Alpha, Index, body.Position, body.Velocity);
+        }
+        else
+        {
+            body.Position = A->Position.Get(Index);
+            body.Velocity = A->Velocity.Get(Index);
+        }
+    };
+
+    const int32 NumC = CelestialBodies.Num();
+
+    for (int32 i = 0; i < NumC; ++i)
+        Apply(*CelestialBodies[i], i);
+
+    for (int32 i = 0; i < PhysicBodies.Num(); ++i)
+        Apply(*PhysicBodies[i], NumC + i);
+}
+
+bool ASimGameMode::BuildEphemeris
+(
+    double DaysBefore,
+    double DaysAfter
+)
+{
+    if (CelestialBodies.Num() == 0)
+        return false;
+
+    // actors hold the shown state
+    PauseSimulation();
+
+    FSimStateStore Celestial;
+    Celestial.Gather(CelestialBodies, {});
+
+    TArray<FString> Names;
+    for (const auto& c_body : CelestialBodies)
+        Names.Emplace(c_body->BodyName);
+
+    Engine.Settings = GetEngineSettings();
+    Engine.BuildEphemeris(
+        Celestial, Names,
+        -86400 * FMath::Max(DaysBefore, 0.),
+        86400 * FMath::Max(DaysAfter, 0.));
+
+    return true;
+}
+
+bool ASimGameMode::SaveEphemeris
+(
+    const FString& File
+) const
+{
+    return Engine.Ephemeris.Num() > 0 && USimFileManager::SaveEphemeris(Engine.Ephemeris, File);
+}
+
+bool ASimGameMode::LoadEphemeris
+(
+    const FString& File
+)
+{
+    PauseSimulation();
+
+    return USimFileManager::LoadEphemeris(Engine.Ephemeris, File);
+}
+
+bool ASimGameMode::SaveAccessWindows
+(
+    double Days,
+    const FString& File
+) const
+{
+    // actors hold the shown state
+    FSimStateStore State;
+    State.Gather(CelestialBodies, PhysicBodies);
+
+    TArray<FSimAccessStation> Stations;
+    TArray<FString> StationNames;
+
+    for (const ASimBaseStation* Station : BaseStations)
+    {
+        const int32 Body = CelestialBodies.Find(Station->CelestialBody);
+
+        if (Body == INDEX_NONE)
+            continue;
+
+        FSimAccessStation& AccessStation = Stations.Emplace_GetRef();
+
+        AccessStation.Body = Body;
+        AccessStation.Latitude = Station->Latitude;
+        AccessStation.Longitude = Station->Longitude;
+
+        StationNames.Emplace(Station->GetActorNameOrLabel());
+    }
+
+    TArray<FString> SatelliteNames;
+    for (const ASimBody* Body : PhysicBodies)
+        SatelliteNames.Emplace(Body->BodyName);
+
+    FSimAccessPlanner Planner;
+    Planner.Reset(State, WorldTime, Stations);
+
+    TArray<FSimAccessWindow> Windows;
+    Planner.Compute(86400 * FMath::Max(Days, 0.), Windows);
+
+    return USimFileManager::SaveAccessWindows(Windows, WorldTime, StationNames, SatelliteNames, File);
+}
+
+void ASimGameMode::JumpToTime
+(
+    FDateTime Time
+)
+{
+    JumpStart = WorldTime;
+    JumpTarget = Time;
+    JumpDirection = FMath::Sign((Time - WorldTime).GetTicks());
+    JumpProgress = 0;
+    Jumping = JumpDirection != 0;
+}
+
+void ASimGameMode::CancelJump()
+{
+    Jumping = false;
+}
+
+void ASimGameMode::UpdateJump()
+{
+    const auto& Snapshots = PhysicsThread->Snapshots;
+    const FSimSnapshot* Shown = Snapshots.Peek();
+
+    if (Shown == nullptr)
+        return;
+
+    const double Span = (JumpTarget - JumpStart).GetTotalSeconds();
+    JumpProgress = FMath::Clamp((Shown->Time - JumpStart).GetTotalSeconds() / Span, 0., 1.);
+
+    // physics stops where a step would pass the target
+    const bool Reached = JumpDirection > 0 ? Shown->Time + dt >= JumpTarget :
+                                             Shown->Time <= JumpTarget;
+
+    if (Reached && Snapshots.Peek(1) == nullptr)
+    {
+        WorldTime = JumpTarget;
+        JumpProgress = 1;
+        Jumping = false;
+    }
+}
+
+int32 ASimGameMode::StepSimulation
+(
+    const FDateTime& Target,
+    int32 Direction
+)
+{
+    if (!Engine.IsAhead(Target, Direction))
+        return 0;
+
+    // properties posted since the last step, never read here directly
+    TakeStepSettings();
+
+    const bool Logging = LogEnabled;
+
+    if (!Logging)
+    {
+        if (const int64 Steps = Engine.Skip(Target, Direction))
+            return static_cast<int32>(FMath::Min<int64>(Steps, MAX_int32));
+    }
+    else if (!WriteLogSamples(Direction))
+    {
+        return 0;
+    }
+
+    if (Logging)
+        LogDense.BeginStep(Engine);
+
+    Engine.Step(Direction);
+
+    if (Logging)
+    {
+        LogDense.EndStep(Engine);
+
+        // samples inside the step, the rest waits for the next call
+        WriteLogSamples(Direction);
+    }
+
+    return 1;
+}
+
+bool ASimGameMode::WriteLogSamples
+(
+    int32 Direction
+)
+{
+    // a new log samples at once
+    const int32 Session = LogSession;
+    if (Session != LogSampledSession || Direction != LogSampledDirection)
+    {
+        LogSampledSession = Session;
+        LogSampledDirection = Direction;
+        LogNextSample = Engine.UpdatedTo;
+    }
+
+    const FTimespan Interval = FTimespan::FromSeconds(Direction * FMath::Max(StepSettings.LogSampleInterval, 0.001));
+
+    while (Direction * (Engine.UpdatedTo - LogNextSample).GetTicks() >= 0)
+    {
+        // the state was replaced since, epochs start over from it
+        if (!LogDense.Covers(Engine, LogNextSample))
+        {
+            LogNextSample = Engine.UpdatedTo;
+            continue;
+        }
+
+        FSimCoverageSample* Sample = LogSamples->BeginWrite();
+
+        // the log is behind
+        if (Sample == nullptr)
+        {
+            if (StepSettings.LogBackpressure == ESimLogBackpressure::Throttle)
+                return false;
+
+            ++LogDropped;
+        }
+        else
+        {
+            Sample->Time = LogNextSample;
+            Sample->Session = Session;
+            LogDense.GetPositions(Engine, LogNextSample, Sample->Positions);
+
+            // origin body as it is at the sample time
+            Sample->Radius = Engine.State.Radius[0];
+            Sample->Rotation = Engine.GetRotation(0, LogNextSample);
+
+            LogSamples->EndWrite();
+        }
+
+        LogNextSample += Interval;
+    }
+
+    return true;
+}
+
+void ASimGameMode::SetPropagation
+(
+    ESimPropagation NewPropagation
+)
+{
+    PauseSimulation();
+
+    Propagation = NewPropagation;
+    StateDirty = true;
+}
+
+void ASimGameMode::SetBodyPropagation
+(
+    ASimBody* Body,
+    ESimPropagation NewPropagation
+)
+{
+    if (Body == nullptr)
+        return;
+
+    PauseSimulation();
+
+    Body->Propagation = NewPropagation;
+    StateDirty = true;
+}
+
+int32 ASimGameMode::PartitionPhysicBodies()
+{
+    if (Propagation == ESimPropagation::Analytic)
+        return PhysicBodies.Num();
+
+    // analytic bodies go last, keeping relative order
+    TArray<ASimBody*> AnalyticBodies;
+    int32 NumNumeric = 0;
+
+    for (const auto& body : PhysicBodies)
+    {
+        if (body->Propagation == ESimPropagation::Analytic)
+            AnalyticBodies.Emplace(body);
+        else
+            PhysicBodies[NumNumeric++] = body;
+    }
+
+    PhysicBodies.SetNum(NumNumeric);
+    PhysicBodies.Append(AnalyticBodies);
+
+    return AnalyticBodies.Num();
+}
+
 ASimBody* ASimGameMode::SpawnBody(const FString& Name, ASimCelestialBody* const MainBody, double SemiMajorAxis, double Eccentricity, double Inclination, double LongitudeOfAscendingNode, double ArgumentOfPerigee, double TrueAnomaly)
 {
     if (!NewBodyClass)
@@ -261,49 +706,13 @@ bool ASimGameMode::SetBodyOrbit
     double TrueAnomaly // θ
 )
 {
-    Inclination = FMath::DegreesToRadians(Inclination);
-    LongitudeOfAscendingNode = FMath::DegreesToRadians(LongitudeOfAscendingNode);
-    ArgumentOfPerigee = FMath::DegreesToRadians(ArgumentOfPerigee);
-    TrueAnomaly = FMath::DegreesToRadians(TrueAnomaly);
-
-    double sini = sin(Inclination);
-    double cosi = cos(Inclination);
-
-    double sinΩ = sin(LongitudeOfAscendingNode);
-    double cosΩ = cos(LongitudeOfAscendingNode);
-
-    double sinω = sin(ArgumentOfPerigee);
-    double cosω = cos(ArgumentOfPerigee);
-
-    double sinθ = sin(TrueAnomaly);
-    double cosθ = cos(TrueAnomaly);
-
-    // Eccentric anomaly
-    double cosE = (Eccentricity + cosθ) / (1 + Eccentricity * cosθ);
-    double sinE = FMath::Sign(sinθ) * sqrt(1 - cosE * cosE);
+    PauseSimulation();
 
-    double Distance = 1000. * SemiMajorAxis * (1 - Eccentricity * cosE);
-
-    double temp0 = sqrt(MainBody->GM /* µ */ * 1000. * SemiMajorAxis) / Distance;
-
-    // orbital frame velocity
-    double OVx = -temp0 * sinE;
-    double OVy = temp0 * sqrt(1 - Eccentricity * Eccentricity) * cosE;
-
-    double temp11 = -cosω * cosΩ + sinω * cosi * sinΩ;
-    double temp12 = -sinω * cosΩ - cosω * cosi * sinΩ;
-    double temp21 = -cosω * sinΩ - sinω * cosi * cosΩ;
-    double temp22 = -cosω * cosi * cosΩ + sinω * sinΩ;
-    double temp31 =  sinω * sini;
-    double temp32 =  cosω * sini;
-
-    FVector Radius(Distance * (cosθ * temp11 - sinθ * temp12),
-                  -Distance * (cosθ * temp21 + sinθ * temp22),
-                   Distance * (cosθ * temp31 + sinθ * temp32));
-
-    FVector Velocity(OVx * temp11 - OVy * temp12,
-                   -(OVx * temp21 + OVy * temp22),
-                     OVx * temp31 + OVy * temp32);
+    FVector Radius, Velocity;
+    FSimEngine::OrbitToState(MainBody->GM,
+                             SemiMajorAxis, Eccentricity, Inclination,
+                             LongitudeOfAscendingNode, ArgumentOfPerigee, TrueAnomaly,
+                             Radius, Velocity);
 
     NewBody->Position = MainBody->Position + Radius;
     NewBody->Velocity = MainBody->Velocity + Velocity;
@@ -318,6 +727,8 @@ bool ASimGameMode::SetBodyOrbit
     if (PhysicBodies.Find(NewBody) == INDEX_NONE)
         PhysicBodies.Emplace(NewBody);
 
+    StateDirty = true;
+
     return true;
 }
 
@@ -330,6 +741,8 @@ void ASimGameMode::SetOrigin
 
     if (Index < 0)
         return;
+
+    PauseSimulation();
     
     std::swap(CelestialBodies[Index], CelestialBodies[0]);
     ASimCelestialBody& origin = *CelestialBodies[0];
@@ -351,13 +764,18 @@ void ASimGameMode::SetOrigin
 
     origin.Position = origin.Velocity = FVector::Zero();
 
+    StateDirty = true;
+
     if (TrajectoriesHandler != nullptr) {
         TrajectoriesHandler->LineBatchComponent->BatchedLines = {};
         TrajectoriesHandler->LinesToDraw = {};
     }
 }
 
-inline void ASimGameMode::UpdateTrajectoryLines()
+inline void ASimGameMode::UpdateTrajectoryLines
+(
+    const FSimSnapshot& Snapshot
+)
 {
     if (TrajectoriesHandler == nullptr)
         return;
@@ -365,12 +783,14 @@ inline void ASimGameMode::UpdateTrajectoryLines()
     int32 NumP = PhysicBodies.Num();
     int32 NumC = CelestialBodies.Num();
 
-    auto lambda = [&](ASimBody& body, FLinearColor Color) -> void
+    auto lambda = [&](ASimBody& body, int32 Index, FLinearColor Color) -> void
     {
-        if (body.TrajectoryCounter++ ==
+        body.TrajectoryCounter += Snapshot.Steps;
+
+        if (body.TrajectoryCounter >
             body.TrajectoryCounterPeriod)
         {
-            FVector NewTrajectoryPoint = body.Position * 100;
+            FVector NewTrajectoryPoint = Snapshot.Position.Get(Index) * 100;
 
             TrajectoriesHandler->LinesToDraw.Emplace(FBatchedLine(
                 body.PrevTrajectoryPoint,
@@ -388,173 +808,51 @@ inline void ASimGameMode::UpdateTrajectoryLines()
 
     for (int32 i = 1; i < NumC; ++i)
     {
-        lambda( *CelestialBodies[i],
+        lambda( *CelestialBodies[i], i,
               { float(i) / (NumC - 1), 1.f, 0 });
     }
     for (int32 i = 0; i < NumP; ++i)
     {
-        lambda( *PhysicBodies[i],
+        lambda( *PhysicBodies[i], NumC + i,
               { float(i) / (NumP - 1), 0, 1.f });
     }
 }
 
-inline void ASimGameMode::CalculateAccelerations
-(
-    int32 Stage
-)
-const
+FSimEngineSettings ASimGameMode::GetEngineSettings() const
 {
-    // radius vector between bodies
-    FVector r;
-    // distance between bodies
-    double norm_r;
-    // distance square
-    double r2;
-    // distance power 4
-    double r4;
-    // z component of radius vector squared
-    double z2;
-    // direction of J2 pertuberation acceleration
-    FVector dJ2;
-
-    // calculate acceleration between celestial bodies 
-    for (int32 i = 0; i < CelestialBodies.Num() - 1; ++i)
-    {
-        ASimCelestialBody& body1 = *CelestialBodies[i];
-
-        for (int32 j = i + 1; j < CelestialBodies.Num(); ++j)
-        {
-            ASimCelestialBody& body2 = *CelestialBodies[j];
-
-            if (body1.GM == 0 && body2.GM == 0)
-                continue;
-
-            r = body2.P[Stage] - body1.P[Stage];
-            r2 = r.X * r.X + r.Y * r.Y + r.Z * r.Z;
-            norm_r = FMath::Sqrt(r2);
-
-            if (body2.GM != 0)
-                body1.A[Stage] += r * (body2.GM / (norm_r * r2));
-
-            if (body1.GM != 0)
-                body2.A[Stage] -= r * (body1.GM / (norm_r * r2));
-        }
-    }
-
-    // calculate acceleration between celestial and other bodies
-    for (const auto& body1 : CelestialBodies)
-    {
-        ASimCelestialBody& c_body = *body1;
-
-        for (const auto& body2 : PhysicBodies)
-        {
-            ASimBody& p_body = *body2;
-
-            if (c_body.GM == 0)
-                continue;
-
-            r = c_body.P[Stage] - p_body.P[Stage];
-            r2 = r.X * r.X + r.Y * r.Y + r.Z * r.Z;
-            norm_r = FMath::Sqrt(r2);
-
-            p_body.A[Stage] += r * c_body.GM / (norm_r * r2);
-
-            if (c_body.J2 == 0)
-                continue;
-
-            r4 = r2 * r2;
-            z2 = r.Z * r.Z;
-            dJ2 = {
-                r.X / norm_r * (5 * z2 / r2 - 1),
-                r.Y / norm_r * (5 * z2 / r2 - 1),
-                r.Z / norm_r * (5 * z2 / r2 - 3),
-            };
-
-            p_body.A[Stage] -= dJ2 * (
-                1.5e6 * c_body.J2 * c_body.GM *
-                c_body.Radius * c_body.Radius / r4);
-        }
-    }
-}
-
-inline void ASimGameMode::IntegrationStage
-(
-    ASimBody& Body,
-    double StepLength,
-    int32 Stage
-)
-const
-{
-    Body.V[Stage + 1] += StepLength * Body.A[Stage];
-
-    Body.P[Stage + 1] += StepLength * Body.V[Stage] +
-        StepLength * StepLength * Body.A[Stage] / 2;
-}
-
-void ASimGameMode::IntegrationStep
-(
-    ASimBody& Body,
-    double StepLength
-)
-const
-{
-    Body.Velocity += (StepLength / 6) * (
-        Body.A[0] +
-        2 * (Body.A[1] + Body.A[2]) +
-        Body.A[3]
-        );
-
-    Body.Position += (StepLength / 6) * (
-        Body.V[0] +
-        2 * (Body.V[1] + Body.V[2]) +
-        Body.V[3]
-        );
+    FSimEngineSettings Settings;
+
+    Settings.Integrator = Integrator;
+    Settings.Propagation = Propagation;
+    Settings.RelativeTolerance = RelativeTolerance;
+    Settings.PositionTolerance = PositionTolerance;
+    Settings.MaxStep = MaxStep;
+    Settings.CorrectorEvaluation = CorrectorEvaluation;
+    Settings.CelestialEphemeris = CelestialEphemeris;
+    Settings.EphemerisStep = EphemerisStep;
+    Settings.ParallelIntegration = ParallelIntegration;
+    Settings.ParallelChunkSize = ParallelChunkSize;
+    Settings.VectorizedIntegration = VectorizedIntegration;
+
+    return Settings;
 }
 
-inline void ASimGameMode::Integrate
+void ASimGameMode::SetEngineSettings
 (
-    double DeltaTime
+    const FSimEngineSettings& Settings
 )
 {
-    double h = DeltaTime / 2;
-
-    // set default values
-    for (const auto& body : CelestialBodies)
-        body->ClearBuffers();
-
-    for (const auto& body : PhysicBodies)
-        body->ClearBuffers();
-
-    // 4 stages of integration
-    for (int32 k = 0; k < 4; ++k)
-    {
-        CalculateAccelerations(k);
-
-        for (int32 i = 1; i < CelestialBodies.Num(); ++i)
-        {
-            CelestialBodies[i]->A[k] -= CelestialBodies[0]->A[k];
-        }
-        for (const auto& body : PhysicBodies)
-        {
-            body->A[k] -= CelestialBodies[0]->A[k];
-        }
-
-        if (k == 2)
-            h = DeltaTime;
-        
-        if (k == 3)
-            break;
-
-        for (int32 i = 1; i < CelestialBodies.Num(); ++i)
-            IntegrationStage(*CelestialBodies[i], h, k);
-
-        for (const auto& body : PhysicBodies)
-            IntegrationStage(*body, h, k);
-    }
-
-    for (int32 i = 1; i < CelestialBodies.Num(); ++i)
-        IntegrationStep(*CelestialBodies[i], DeltaTime);
-
-    for (const auto& body : PhysicBodies)
-        IntegrationStep(*body, DeltaTime);
+    Integrator = Settings.Integrator;
+    RelativeTolerance = Settings.RelativeTolerance;
+    PositionTolerance = Settings.PositionTolerance;
+    MaxStep = Settings.MaxStep;
+    CorrectorEvaluation = Settings.CorrectorEvaluation;
+    CelestialEphemeris = Settings.CelestialEphemeris;
+    EphemerisStep = Settings.EphemerisStep;
+    ParallelIntegration = Settings.ParallelIntegration;
+    ParallelChunkSize = Settings.ParallelChunkSize;
+    VectorizedIntegration = Settings.VectorizedIntegration;
+
+    if (Settings.Propagation != Propagation)
+        SetPropagation(Settings.Propagation);
 }
@@ -0,0 +1,191 @@
+// DHmelevcev 2025
+
+#include "SimGroundTerminals.h"
+#include "SimFootprint.h"
+#include "Async/ParallelFor.h"
+
+FSimGroundTerminals::FSimGroundTerminals
+(
+	double Resolution
+)
+{
+	const int32 NumRows = FMath::Max(FMath::RoundToInt32(180 / FMath::Max(Resolution, 0.01)), 1);
+	Height = 180. / NumRows;
+
+	Rows.SetNumUninitialized(NumRows);
+
+	int32 NumCells = 0;
+
+	for (int32 j = 0; j < NumRows; ++j)
+	{
+		FRow& Row = Rows[j];
+		const double Latitude = 90 - (j + 0.5) * Height;
+
+		// the same rings as ESimCoverageGrid::EqualArea
+		Row.Num = FMath::Max(FMath::RoundToInt32(2 * NumRows * FMath::Cos(FMath::DegreesToRadians(Latitude))), 1);
+		Row.Offset = NumCells;
+		Row.Width = 360. / Row.Num;
+
+		NumCells += Row.Num;
+	}
+
+	CellFirst.SetNumZeroed(NumCells + 1);
+}
+
+int32 FSimGroundTerminals::Add
+(
+	double Latitude,
+	double Longitude
+)
+{
+	Latitudes.Emplace(FMath::Clamp(Latitude, -90., 90.));
+	Longitudes.Emplace(FMath::UnwindDegrees(Longitude));
+
+	Dirty = true;
+
+	return Latitudes.Num() - 1;
+}
+
+void FSimGroundTerminals::Reset()
+{
+	Latitudes.Reset();
+	Longitudes.Reset();
+
+	Dirty = true;
+}
+
+int32 FSimGroundTerminals::GetRow
+(
+	double Latitude
+) const
+{
+	return FMath::Clamp(FMath::FloorToInt32((90 - Latitude) / Height), 0, Rows.Num() - 1);
+}
+
+int32 FSimGroundTerminals::GetColumn
+(
+	int32 Row,
+	double Longitude
+) const
+{
+	return FMath::Clamp(FMath::FloorToInt32((Longitude + 180) / Rows[Row].Width), 0, Rows[Row].Num - 1);
+}
+
+void FSimGroundTerminals::Build()
+{
+	const int32 NumCells = CellFirst.Num() - 1;
+	const int32 NumTerminals = Latitudes.Num();
+
+	TArray<int32> Cells;
+	Cells.SetNumUninitialized(NumTerminals);
+
+	FMemory::Memzero(CellFirst.GetData(), CellFirst.Num() * sizeof(int32));
+
+	for (int32 t = 0; t < NumTerminals; ++t)
+	{
+		const int32 Row = GetRow(Latitudes[t]);
+
+		Cells[t] = Rows[Row].Offset + GetColumn(Row, Longitudes[t]);
+		++CellFirst[Cells[t] + 1];
+	}
+
+	for (int32 k = 0; k < NumCells; ++k)
+		CellFirst[k + 1] += CellFirst[k];
+
+	CellTerminals.SetNumUninitialized(NumTerminals);
+	CellUps.SetNumUninitialized(NumTerminals);
+
+	TArray<int32> Next(CellFirst.GetData(), NumCells);
+
+	for (int32 t = 0; t < NumTerminals; ++t)
+	{
+		const int32 k = Next[Cells[t]]++;
+
+		// body-fixed, longitude L points to -(L + 180) deg. as stations do
+		double SinLat, CosLat, SinA, CosA;
+		FMath::SinCos(&SinLat, &CosLat, FMath::DegreesToRadians(Latitudes[t]));
+		FMath::SinCos(&SinA, &CosA, FMath::DegreesToRadians(-(Longitudes[t] + 180)));
+
+		CellTerminals[k] = t;
+		CellUps[k] = FVector(CosLat * CosA, CosLat * SinA, SinLat);
+	}
+
+	Dirty = false;
+}
+
+void FSimGroundTerminals::FindVisible
+(
+	const TArray<FVector>& Positions,
+	double Radius,
+	double Rotation,
+	TArray<int32>& OutFirst,
+	TArray<int32>& OutTerminals
+)
+{
+	if (Dirty)
+		Build();
+
+	// satellites to body-fixed coordinates
+	const FRotator ToBody(0, -Rotation, 0);
+
+	if (Visible.Num() < Positions.Num())
+		Visible.SetNum(Positions.Num());
+
+	Tested.SetNumUninitialized(Positions.Num(), false);
+
+	ParallelFor(Positions.Num(), [&](int32 s)
+	{
+		TArray<int32>& SatelliteVisible = Visible[s];
+		SatelliteVisible.Reset();
+		Tested[s] = 0;
+
+		FSimFootprint Footprint;
+
+		if (Latitudes.IsEmpty() || !Footprint.Set(ToBody.RotateVector(Positions[s]), Radius))
+			return;
+
+		int32 FirstRow, LastRow;
+		Footprint.GetRows(Height, Rows.Num(), FirstRow, LastRow);
+
+		for (int32 j = FirstRow; j <= LastRow; ++j)
+		{
+			const FRow& Row = Rows[j];
+			const double Top = 90 - j * Height;
+
+			// terminals lie anywhere in a cell, not only at its centre
+			double SinRow, CosRow;
+			FMath::SinCos(&SinRow, &CosRow, FMath::DegreesToRadians(Footprint.GetWidestLatitude(Top - Height, Top)));
+
+			int32 First, Last;
+			if (!Footprint.GetColumns(SinRow, CosRow, Row.Width, Row.Num, First, Last))
+				continue;
+
+			for (int32 c = First; c <= Last; ++c)
+			{
+				const int32 Cell = Row.Offset + (c % Row.Num + Row.Num) % Row.Num;
+
+				for (int32 k = CellFirst[Cell]; k < CellFirst[Cell + 1]; ++k)
+					if (Footprint.IsVisible(CellUps[k]))
+						SatelliteVisible.Emplace(CellTerminals[k]);
+
+				Tested[s] += CellFirst[Cell + 1] - CellFirst[Cell];
+			}
+		}
+	});
+
+	OutFirst.SetNumUninitialized(Positions.Num() + 1, false);
+	OutFirst[0] = 0;
+
+	NumTested = 0;
+
+	for (int32 s = 0; s < Positions.Num(); ++s)
+	{
+		OutFirst[s + 1] = OutFirst[s] + Visible[s].Num();
+		NumTested += Tested[s];
+	}
+
+	OutTerminals.SetNumUninitialized(OutFirst.Last(), false);
+
+	for (int32 s = 0; s < Positions.Num(); ++s)
+		FMemory::Memcpy(OutTerminals.GetData() + OutFirst[s], Visible[s].GetData(), Visible[s].Num() * sizeof(int32));
+}
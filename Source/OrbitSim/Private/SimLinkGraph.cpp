@@ -0,0 +1,97 @@
+// DHmelevcev 2025
+
+#include "SimLinkGraph.h"
+#include "Algo/Reverse.h"
+
+void FSimLinkGraph::Assign
+(
+	const FSimLinkInput& Input,
+	const TArray<FIntPoint>& iLinks
+)
+{
+	// Reset and Append keep memory of the previous assignment
+	Nodes.Reset();
+	Nodes.Append(Input.Nodes);
+	NumSatellites = Input.NumSatellites;
+
+	// counting sort of links by their lower node
+	First.Reset();
+	First.AddZeroed(Nodes.Num() + 1);
+
+	for (const FIntPoint& Link : iLinks)
+		++First[Link.X + 1];
+
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+		First[i + 1] += First[i];
+
+	Targets.SetNumUninitialized(iLinks.Num(), false);
+
+	for (const FIntPoint& Link : iLinks)
+		Targets[First[Link.X]++] = Link.Y;
+
+	// bounds moved up by one row while filling
+	for (int32 i = Nodes.Num(); i > 0; --i)
+		First[i] = First[i - 1];
+
+	First[0] = 0;
+
+	Parents.Reset();
+}
+
+void FSimLinkGraph::SetRoutes
+(
+	const TArray<int32>& iParents
+)
+{
+	Parents.Reset();
+	Parents.Append(iParents);
+}
+
+double FSimLinkGraph::GetLatency
+(
+	int32 Station,
+	int32 Node
+) const
+{
+	const int32 Source = NumSatellites + Station;
+
+	if (Parents.Num() != GetNumStations() * Num() || !Nodes.IsValidIndex(Source) || !Nodes.IsValidIndex(Node))
+		return -1;
+
+	const int32* Parent = &Parents[Station * Num()];
+	double Distance = 0;
+
+	// parents lead to the station, a route has fewer hops than nodes
+	for (int32 Hops = 0; Node != Source && Hops < Num(); ++Hops)
+	{
+		if (Parent[Node] == INDEX_NONE)
+			return -1;
+
+		Distance += FVector::Dist(Nodes[Node], Nodes[Parent[Node]]);
+		Node = Parent[Node];
+	}
+
+	return Node == Source ? Distance / SpeedOfLight : -1;
+}
+
+void FSimLinkGraph::GetPath
+(
+	int32 Station,
+	int32 Node,
+	TArray<int32>& OutPath
+) const
+{
+	OutPath.Reset();
+
+	if (GetLatency(Station, Node) < 0)
+		return;
+
+	const int32 Source = NumSatellites + Station;
+	const int32* Parent = &Parents[Station * Num()];
+
+	for (; Node != Source; Node = Parent[Node])
+		OutPath.Emplace(Node);
+
+	OutPath.Emplace(Source);
+	Algo::Reverse(OutPath);
+}
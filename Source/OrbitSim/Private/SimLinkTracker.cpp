@@ -0,0 +1,353 @@
+// DHmelevcev 2025
+
+#include "SimLinkTracker.h"
+#include "SimFootprint.h"
+#include "Async/ParallelFor.h"
+
+// pairs tested at once, bounds scratch memory of a rebuild
+constexpr int32 DueBatchSize = 1 << 16;
+
+bool FSimLinkTracker::Update
+(
+	FSimLinkInput& iInput
+)
+{
+	const bool Rebuild = NeedsRebuild(iInput);
+	const double DeltaTime = iInput.Time - Input.Time;
+
+	Swap(Input, iInput);
+	Due.Reset();
+
+	Rebuilt = Rebuild;
+	Risen.Reset();
+	Set.Reset();
+
+	NumTested = 0;
+
+	Shells.Reset();
+
+	for (int32 k = 0; k < Input.Occluders.Num(); ++k)
+		Shells.Emplace(FSimOcclusionKernel::MakeOccluder(Input.Occluders[k], Input.OccluderRadii[k]));
+
+	bool Changed = Rebuild;
+
+	if (Rebuild)
+	{
+		double MaxSpeed = 0;
+		for (double Speed : Input.Speeds)
+			MaxSpeed = FMath::Max(MaxSpeed, Speed);
+
+		// two nodes close in by at most twice the fastest speed
+		FindCandidates(Input.MaxDistance > 0 ? Input.MaxDistance + 2 * MaxSpeed * ListHorizon : 0);
+		Elapsed = 0;
+
+		Linked.Reset();
+		Linked.AddZeroed(Pairs.Num());
+		Events.Reset(Pairs.Num());
+
+		for (int32 Begin = 0; Begin < Pairs.Num(); Begin += DueBatchSize)
+		{
+			Due.Reset();
+
+			for (int32 p = Begin; p < FMath::Min(Begin + DueBatchSize, Pairs.Num()); ++p)
+				Due.Emplace(p);
+
+			TestDue(Due.GetData(), Due.Num(), Rebuild, Changed);
+		}
+	}
+	else
+	{
+		// the path nodes take is no shorter than their displacement,
+		// so margins hold whichever way time runs
+		Elapsed += FMath::Abs(DeltaTime);
+
+		// all due pairs first, some are due again right after their test
+		while (Events.Num() > 0 && Events.HeapTop().Time <= Elapsed)
+		{
+			FEvent Event;
+			Events.HeapPop(Event, false);
+			Due.Emplace(Event.Pair);
+		}
+
+		for (int32 Begin = 0; Begin < Due.Num(); Begin += DueBatchSize)
+			TestDue(Due.GetData() + Begin, FMath::Min(DueBatchSize, Due.Num() - Begin), Rebuild, Changed);
+	}
+
+	if (Changed)
+	{
+		Links.Reset();
+
+		for (int32 p = 0; p < Pairs.Num(); ++p)
+			if (Linked[p])
+				Links.Emplace(Pairs[p]);
+	}
+
+	return Changed;
+}
+
+void FSimLinkTracker::TestDue
+(
+	const int32* Batch,
+	int32 Num,
+	bool Rebuild,
+	bool& Changed
+)
+{
+	NumTested += Num;
+
+	DueSafe.SetNumUninitialized(Num, false);
+	DueLinked.SetNumUninitialized(Num, false);
+
+	for (auto* Column : { &DueAX, &DueAY, &DueAZ, &DueBX, &DueBY, &DueBZ })
+		Column->SetNumUninitialized(Num, false);
+
+	DueClear.SetNumUninitialized((Num + 63) / 64, false);
+
+	const auto Occlusion = VectorizedOcclusion ? &FSimOcclusionKernel::Test :
+	                                             &FSimOcclusionKernel::TestScalar;
+
+	// chunks start at multiples of 64 to write their own words of clear bits
+	constexpr int32 ChunkSize = 1024;
+
+	ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+	{
+		const int32 Begin = Chunk * ChunkSize;
+		const int32 End = FMath::Min(Begin + ChunkSize, Num);
+
+		for (int32 k = Begin; k < End; ++k)
+		{
+			const FVector& a = Input.Nodes[Pairs[Batch[k]].X];
+			const FVector& b = Input.Nodes[Pairs[Batch[k]].Y];
+
+			DueAX[k] = a.X;
+			DueAY[k] = a.Y;
+			DueAZ[k] = a.Z;
+			DueBX[k] = b.X;
+			DueBY[k] = b.Y;
+			DueBZ[k] = b.Z;
+		}
+
+		Occlusion(Shells, DueAX.GetData(), DueAY.GetData(), DueAZ.GetData(),
+		          DueBX.GetData(), DueBY.GetData(), DueBZ.GetData(), Begin, End, DueClear.GetData());
+
+		for (int32 k = Begin; k < End; ++k)
+			DueLinked[k] = Evaluate(Batch[k], (DueClear[k / 64] >> (k % 64)) & 1, DueSafe[k]);
+	});
+
+	for (int32 k = 0; k < Num; ++k)
+	{
+		const int32 p = Batch[k];
+
+		if (Linked[p] != DueLinked[k])
+		{
+			Changed = true;
+
+			if (!Rebuild)
+				(DueLinked[k] ? Risen : Set).Emplace(Pairs[p]);
+		}
+
+		Linked[p] = DueLinked[k];
+
+		Events.HeapPush({ Elapsed + DueSafe[k], p });
+	}
+}
+
+void FSimLinkTracker::CopyLinks
+(
+	FSimLinkGraph& Graph
+) const
+{
+	Graph.Assign(Input, Links);
+}
+
+bool FSimLinkTracker::NeedsRebuild
+(
+	const FSimLinkInput& NewInput
+) const
+{
+	if (Pairs.IsEmpty() ||
+		NewInput.Nodes.Num() != Input.Nodes.Num() ||
+		NewInput.NumSatellites != Input.NumSatellites ||
+		NewInput.Occluders.Num() != Input.Occluders.Num() ||
+		NewInput.MaxDistance != Input.MaxDistance)
+		return true;
+
+	const double DeltaTime = FMath::Abs(NewInput.Time - Input.Time);
+
+	if (Input.MaxDistance > 0 && Elapsed + DeltaTime > ListHorizon)
+		return true;
+
+	// a body was moved outside of its orbit, bounds do not hold for it
+	for (int32 i = 0; i < Input.Nodes.Num(); ++i)
+	{
+		const double Reach = FMath::Max(Input.Speeds[i], NewInput.Speeds[i]) * DeltaTime * 1.1 + 1;
+
+		if (FVector::DistSquared(Input.Nodes[i], NewInput.Nodes[i]) > Reach * Reach)
+			return true;
+	}
+
+	return false;
+}
+
+void FSimLinkTracker::FindCandidates
+(
+	double Radius
+)
+{
+	const int32 N = Input.Nodes.Num();
+
+	Pairs.Reset();
+
+	if (Radius <= 0)
+	{
+		Pairs.Reserve(N * (N - 1) / 2);
+
+		for (int32 i = 0; i < N; ++i)
+			for (int32 j = i + 1; j < N; ++j)
+				Pairs.Emplace(i, j);
+
+		return;
+	}
+
+	NodeCells.SetNumUninitialized(N);
+
+	for (int32 i = 0; i < N; ++i)
+	{
+		const FVector Cell = Input.Nodes[i] / Radius;
+
+		// clamped far out, a tiny Radius must not overflow the cell index
+		NodeCells[i] = FIntVector(FMath::FloorToInt32(FMath::Clamp(Cell.X, -1e9, 1e9)),
+		                          FMath::FloorToInt32(FMath::Clamp(Cell.Y, -1e9, 1e9)),
+		                          FMath::FloorToInt32(FMath::Clamp(Cell.Z, -1e9, 1e9)));
+	}
+
+	CellNodes.SetNumUninitialized(N);
+
+	for (int32 i = 0; i < N; ++i)
+		CellNodes[i] = i;
+
+	CellNodes.Sort([this](int32 a, int32 b)
+	{
+		const FIntVector& A = NodeCells[a];
+		const FIntVector& B = NodeCells[b];
+
+		return A.X != B.X ? A.X < B.X :
+		       A.Y != B.Y ? A.Y < B.Y :
+		       A.Z != B.Z ? A.Z < B.Z : a < b;
+	});
+
+	Cells.Reset();
+
+	for (int32 k = 0; k < N; ++k)
+	{
+		FInt32Vector2& Range = Cells.FindOrAdd(NodeCells[CellNodes[k]], FInt32Vector2(k, 0));
+		++Range.Y;
+	}
+
+	const double Radius2 = Radius * Radius;
+
+	// every node looks for higher nodes in the 27 cells around its own
+	for (int32 i = 0; i < N; ++i)
+	{
+		const FIntVector& Cell = NodeCells[i];
+
+		for (int32 x = -1; x <= 1; ++x)
+		for (int32 y = -1; y <= 1; ++y)
+		for (int32 z = -1; z <= 1; ++z)
+		{
+			const FInt32Vector2* Range = Cells.Find(Cell + FIntVector(x, y, z));
+
+			if (Range == nullptr)
+				continue;
+
+			for (int32 k = Range->X; k < Range->X + Range->Y; ++k)
+			{
+				const int32 j = CellNodes[k];
+
+				if (j > i && FVector::DistSquared(Input.Nodes[i], Input.Nodes[j]) <= Radius2)
+					Pairs.Emplace(i, j);
+			}
+		}
+	}
+}
+
+bool FSimLinkTracker::Evaluate
+(
+	int32 Pair,
+	bool Clear,
+	double& OutSafe
+) const
+{
+	const int32 i = Pairs[Pair].X;
+	const int32 j = Pairs[Pair].Y;
+
+	const FVector& a = Input.Nodes[i];
+	const FVector& b = Input.Nodes[j];
+	const double sa = Input.Speeds[i];
+	const double sb = Input.Speeds[j];
+
+	const double Distance = FVector::Dist(a, b);
+
+	OutSafe = ListHorizon;
+
+	// time a margin changing at most at Rate takes to reach zero
+	auto Bound = [&OutSafe](double Margin, double Rate)
+	{
+		if (Rate > 0)
+			OutSafe = FMath::Min(OutSafe, FMath::Abs(Margin) / Rate);
+	};
+
+	if (Distance < 1)
+	{
+		OutSafe = 0;
+		return false;
+	}
+
+	bool Visible = true;
+
+	if (Input.MaxDistance > 0)
+	{
+		Visible = Distance <= Input.MaxDistance;
+		Bound(Input.MaxDistance - Distance, sa + sb);
+	}
+
+	Visible = Visible && Clear;
+
+	for (int32 k = 0; k < Input.Occluders.Num(); ++k)
+	{
+		const FVector& o = Input.Occluders[k];
+		const double Shell = Input.OccluderRadii[k] * 1.01;
+		const double so = Input.OccluderSpeeds[k];
+
+		bool Ground = false;
+
+		// ends on the surface see the other end above the mask
+		// while the unit vectors up and along the link turn slowly enough
+		for (int32 End = 0; End < 2; ++End)
+		{
+			const FVector& e = End ? b : a;
+			const FVector& f = End ? a : b;
+			const double se = End ? sb : sa;
+
+			const FVector Up = e - o;
+			const double r = Up.Size();
+
+			if (r >= Shell || r <= 0)
+				continue;
+
+			Ground = true;
+
+			const double SinElevation = FVector::DotProduct(f - e, Up) / (Distance * r);
+			Bound(SinElevation - SinElevationMask, (sa + sb) / Distance + (se + so) / r);
+		}
+
+		// distance to a segment moves no faster than its ends
+		if (!Ground)
+		{
+			const FVector m = FMath::ClosestPointOnSegment(o, a, b);
+			Bound(FVector::Dist(m, o) - Shell, FMath::Max(sa, sb) + so);
+		}
+	}
+
+	return Visible;
+}
@@ -0,0 +1,163 @@
+// DHmelevcev 2025
+
+#include "SimMultistepIntegrator.h"
+
+namespace ABM
+{
+	// Adams-Bashforth, f(n), f(n - 1), ..., f(n - 7)
+	constexpr double B[8] =
+	{
+		 434241. / 120960,
+		-1152169. / 120960,
+		 2183877. / 120960,
+		-2664477. / 120960,
+		 2102243. / 120960,
+		-1041723. / 120960,
+		 295767. / 120960,
+		-36799. / 120960
+	};
+
+	// Adams-Moulton, f(n + 1), f(n), ..., f(n - 6)
+	constexpr double C[8] =
+	{
+		 36799. / 120960,
+		 139849. / 120960,
+		-121797. / 120960,
+		 123133. / 120960,
+		-88547. / 120960,
+		 41499. / 120960,
+		-11351. / 120960,
+		 1375. / 120960
+	};
+}
+
+void FSimMultistepIntegrator::Reset
+(
+	int32 NumBodies
+)
+{
+	for (int32 k = 0; k < Order; ++k)
+	{
+		VHistory[k].SetNum(NumBodies);
+		AHistory[k].SetNum(NumBodies);
+	}
+
+	Newest = Order - 1;
+	NumHistory = 0;
+}
+
+void FSimMultistepIntegrator::Predict
+(
+	FSimStateStore& Store,
+	double StepLength,
+	int32 Begin,
+	int32 End
+) const
+{
+	FSimVectorColumn& P = Store.P[0];
+	FSimVectorColumn& V = Store.V[0];
+
+	for (int32 i = Begin; i < End; ++i)
+	{
+		double dpx = 0, dpy = 0, dpz = 0;
+		double dvx = 0, dvy = 0, dvz = 0;
+
+		for (int32 j = 0; j < Order; ++j)
+		{
+			const FSimVectorColumn& Vj = VHistory[Past(j)];
+			const FSimVectorColumn& Aj = AHistory[Past(j)];
+
+			dpx += ABM::B[j] * Vj.X[i];
+			dpy += ABM::B[j] * Vj.Y[i];
+			dpz += ABM::B[j] * Vj.Z[i];
+
+			dvx += ABM::B[j] * Aj.X[i];
+			dvy += ABM::B[j] * Aj.Y[i];
+			dvz += ABM::B[j] * Aj.Z[i];
+		}
+
+		P.X[i] = Store.Position.X[i] + StepLength * dpx;
+		P.Y[i] = Store.Position.Y[i] + StepLength * dpy;
+		P.Z[i] = Store.Position.Z[i] + StepLength * dpz;
+
+		V.X[i] = Store.Velocity.X[i] + StepLength * dvx;
+		V.Y[i] = Store.Velocity.Y[i] + StepLength * dvy;
+		V.Z[i] = Store.Velocity.Z[i] + StepLength * dvz;
+	}
+}
+
+void FSimMultistepIntegrator::Correct
+(
+	FSimStateStore& Store,
+	double StepLength,
+	int32 Begin,
+	int32 End
+) const
+{
+	const FSimVectorColumn& V = Store.V[0];
+	const FSimVectorColumn& A = Store.A[0];
+
+	for (int32 i = Begin; i < End; ++i)
+	{
+		double dpx = ABM::C[0] * V.X[i];
+		double dpy = ABM::C[0] * V.Y[i];
+		double dpz = ABM::C[0] * V.Z[i];
+
+		double dvx = ABM::C[0] * A.X[i];
+		double dvy = ABM::C[0] * A.Y[i];
+		double dvz = ABM::C[0] * A.Z[i];
+
+		for (int32 j = 1; j < Order; ++j)
+		{
+			const FSimVectorColumn& Vj = VHistory[Past(j - 1)];
+			const FSimVectorColumn& Aj = AHistory[Past(j - 1)];
+
+			dpx += ABM::C[j] * Vj.X[i];
+			dpy += ABM::C[j] * Vj.Y[i];
+			dpz += ABM::C[j] * Vj.Z[i];
+
+			dvx += ABM::C[j] * Aj.X[i];
+			dvy += ABM::C[j] * Aj.Y[i];
+			dvz += ABM::C[j] * Aj.Z[i];
+		}
+
+		Store.Position.X[i] += StepLength * dpx;
+		Store.Position.Y[i] += StepLength * dpy;
+		Store.Position.Z[i] += StepLength * dpz;
+
+		Store.Velocity.X[i] += StepLength * dvx;
+		Store.Velocity.Y[i] += StepLength * dvy;
+		Store.Velocity.Z[i] += StepLength * dvz;
+	}
+}
+
+void FSimMultistepIntegrator::Push
+(
+	const FSimStateStore& Store,
+	int32 Begin,
+	int32 End
+)
+{
+	// overwrites the oldest point, Correct does not use it
+	FSimVectorColumn& Vn = VHistory[(Newest + 1) % Order];
+	FSimVectorColumn& An = AHistory[(Newest + 1) % Order];
+
+	const FSimVectorColumn& A = Store.A[0];
+
+	for (int32 i = Begin; i < End; ++i)
+	{
+		Vn.X[i] = Store.Velocity.X[i];
+		Vn.Y[i] = Store.Velocity.Y[i];
+		Vn.Z[i] = Store.Velocity.Z[i];
+
+		An.X[i] = A.X[i];
+		An.Y[i] = A.Y[i];
+		An.Z[i] = A.Z[i];
+	}
+}
+
+void FSimMultistepIntegrator::Commit()
+{
+	Newest = (Newest + 1) % Order;
+	NumHistory = FMath::Min(NumHistory + 1, Order);
+}
@@ -0,0 +1,317 @@
+// DHmelevcev 2025
+
+#include "SimOcclusionKernel.h"
+#include "SimCpuFeatures.h"
+#include "SimFootprint.h"
+
+constexpr double SinMask2 = SinElevationMask * SinElevationMask;
+
+using FOcclusionFunction = void (*)(const TArray<FSimOccluder>&,
+                                    const double*, const double*, const double*,
+                                    const double*, const double*, const double*,
+                                    int32, int32, uint64*);
+
+FSimOccluder FSimOcclusionKernel::MakeOccluder
+(
+	const FVector& Position,
+	double Radius
+)
+{
+	FSimOccluder Occluder;
+	Occluder.X = Position.X;
+	Occluder.Y = Position.Y;
+	Occluder.Z = Position.Z;
+	Occluder.Shell2 = FMath::Square(Radius * 1.01);
+	return Occluder;
+}
+
+bool FSimOcclusionKernel::IsOccluded
+(
+	const FSimOccluder& Occluder,
+	const FVector& First,
+	const FVector& Second
+)
+{
+	const FVector c(Occluder.X, Occluder.Y, Occluder.Z);
+	const FVector s = Second - First;
+	const FVector v = c - First;
+
+	// the closest point to the centre is First + s * d1 / d2
+	const double d1 = FVector::DotProduct(v, s);
+	const double d2 = FVector::DotProduct(s, s);
+
+	if (d1 > 0 && d1 < d2)
+		return (s * (d1 / d2) - v).SizeSquared() < Occluder.Shell2;
+
+	// closest at an end -> station - satellite connection
+	const bool AtFirst = d1 <= 0;
+	const FVector Up = (AtFirst ? First : Second) - c;
+	const double Up2 = Up.SizeSquared();
+
+	if (Up2 >= Occluder.Shell2)
+		return false;
+
+	// elevation above the mask: Dir . Up >= sin(5 deg.) |Dir| |Up|,
+	// squared to avoid the square roots, |Dir|^2 = d2
+	const double Dot = AtFirst ? FVector::DotProduct(s, Up) : -FVector::DotProduct(s, Up);
+
+	return Dot <= 0 || Dot * Dot < SinMask2 * d2 * Up2;
+}
+
+// zero words of the range, implementations only set bits
+static void ClearWords
+(
+	int32 Begin,
+	int32 End,
+	uint64* OutClear
+)
+{
+	for (int32 w = Begin / 64; w < (End + 63) / 64; ++w)
+		OutClear[w] = 0;
+}
+
+static void SetClearScalar
+(
+	const TArray<FSimOccluder>& Occluders,
+	const double* AX, const double* AY, const double* AZ,
+	const double* BX, const double* BY, const double* BZ,
+	int32 Begin,
+	int32 End,
+	uint64* OutClear
+)
+{
+	for (int32 p = Begin; p < End; ++p)
+	{
+		const FVector a(AX[p], AY[p], AZ[p]);
+		const FVector b(BX[p], BY[p], BZ[p]);
+
+		bool Clear = true;
+
+		for (const FSimOccluder& Occluder : Occluders)
+		{
+			if (FSimOcclusionKernel::IsOccluded(Occluder, a, b))
+			{
+				Clear = false;
+				break;
+			}
+		}
+
+		if (Clear)
+			OutClear[p / 64] |= uint64(1) << (p % 64);
+	}
+}
+
+void FSimOcclusionKernel::TestScalar
+(
+	const TArray<FSimOccluder>& Occluders,
+	const double* AX, const double* AY, const double* AZ,
+	const double* BX, const double* BY, const double* BZ,
+	int32 Begin,
+	int32 End,
+	uint64* OutClear
+)
+{
+	ClearWords(Begin, End, OutClear);
+	SetClearScalar(Occluders, AX, AY, AZ, BX, BY, BZ, Begin, End, OutClear);
+}
+
+#if PLATFORM_CPU_X86_FAMILY
+
+// Both cases of IsOccluded are evaluated for every lane and selected by
+// where the closest point falls, blocked lanes are accumulated over occluders.
+SIM_TARGET_AVX2 static void SetClearAVX2
+(
+	const TArray<FSimOccluder>& Occluders,
+	const double* AX, const double* AY, const double* AZ,
+	const double* BX, const double* BY, const double* BZ,
+	int32 Begin,
+	int32 End,
+	uint64* OutClear
+)
+{
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d mask2 = _mm256_set1_pd(SinMask2);
+
+	int32 p = Begin;
+	for (; p + 4 <= End; p += 4)
+	{
+		const __m256d ax = _mm256_loadu_pd(AX + p);
+		const __m256d ay = _mm256_loadu_pd(AY + p);
+		const __m256d az = _mm256_loadu_pd(AZ + p);
+		const __m256d bx = _mm256_loadu_pd(BX + p);
+		const __m256d by = _mm256_loadu_pd(BY + p);
+		const __m256d bz = _mm256_loadu_pd(BZ + p);
+
+		const __m256d sx = _mm256_sub_pd(bx, ax);
+		const __m256d sy = _mm256_sub_pd(by, ay);
+		const __m256d sz = _mm256_sub_pd(bz, az);
+		const __m256d d2 = _mm256_fmadd_pd(sz, sz, _mm256_fmadd_pd(sy, sy, _mm256_mul_pd(sx, sx)));
+
+		__m256d blocked = zero;
+
+		for (const FSimOccluder& Occluder : Occluders)
+		{
+			const __m256d cx = _mm256_set1_pd(Occluder.X);
+			const __m256d cy = _mm256_set1_pd(Occluder.Y);
+			const __m256d cz = _mm256_set1_pd(Occluder.Z);
+			const __m256d shell2 = _mm256_set1_pd(Occluder.Shell2);
+
+			const __m256d vx = _mm256_sub_pd(cx, ax);
+			const __m256d vy = _mm256_sub_pd(cy, ay);
+			const __m256d vz = _mm256_sub_pd(cz, az);
+			const __m256d d1 = _mm256_fmadd_pd(vz, sz, _mm256_fmadd_pd(vy, sy, _mm256_mul_pd(vx, sx)));
+
+			// closest point inside the segment
+			const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(d1, zero, _CMP_GT_OQ), _mm256_cmp_pd(d1, d2, _CMP_LT_OQ));
+			const __m256d t = _mm256_div_pd(d1, d2);
+			const __m256d mx = _mm256_fmsub_pd(sx, t, vx);
+			const __m256d my = _mm256_fmsub_pd(sy, t, vy);
+			const __m256d mz = _mm256_fmsub_pd(sz, t, vz);
+			const __m256d m2 = _mm256_fmadd_pd(mz, mz, _mm256_fmadd_pd(my, my, _mm256_mul_pd(mx, mx)));
+			const __m256d through = _mm256_and_pd(inside, _mm256_cmp_pd(m2, shell2, _CMP_LT_OQ));
+
+			// closest at an end
+			const __m256d atFirst = _mm256_cmp_pd(d1, zero, _CMP_LE_OQ);
+			const __m256d ux = _mm256_sub_pd(_mm256_blendv_pd(bx, ax, atFirst), cx);
+			const __m256d uy = _mm256_sub_pd(_mm256_blendv_pd(by, ay, atFirst), cy);
+			const __m256d uz = _mm256_sub_pd(_mm256_blendv_pd(bz, az, atFirst), cz);
+			const __m256d u2 = _mm256_fmadd_pd(uz, uz, _mm256_fmadd_pd(uy, uy, _mm256_mul_pd(ux, ux)));
+			const __m256d su = _mm256_fmadd_pd(sz, uz, _mm256_fmadd_pd(sy, uy, _mm256_mul_pd(sx, ux)));
+			const __m256d dot = _mm256_blendv_pd(_mm256_sub_pd(zero, su), su, atFirst);
+
+			const __m256d low = _mm256_or_pd(_mm256_cmp_pd(dot, zero, _CMP_LE_OQ),
+			                                 _mm256_cmp_pd(_mm256_mul_pd(dot, dot), _mm256_mul_pd(mask2, _mm256_mul_pd(d2, u2)), _CMP_LT_OQ));
+			const __m256d grazing = _mm256_andnot_pd(inside, _mm256_and_pd(_mm256_cmp_pd(u2, shell2, _CMP_LT_OQ), low));
+
+			blocked = _mm256_or_pd(blocked, _mm256_or_pd(through, grazing));
+		}
+
+		const uint64 clear = ~_mm256_movemask_pd(blocked) & 0xf;
+		OutClear[p / 64] |= clear << (p % 64);
+	}
+
+	SetClearScalar(Occluders, AX, AY, AZ, BX, BY, BZ, p, End, OutClear);
+}
+
+SIM_TARGET_AVX512 static void SetClearAVX512
+(
+	const TArray<FSimOccluder>& Occluders,
+	const double* AX, const double* AY, const double* AZ,
+	const double* BX, const double* BY, const double* BZ,
+	int32 Begin,
+	int32 End,
+	uint64* OutClear
+)
+{
+	const __m512d zero = _mm512_setzero_pd();
+	const __m512d mask2 = _mm512_set1_pd(SinMask2);
+
+	int32 p = Begin;
+	for (; p + 8 <= End; p += 8)
+	{
+		const __m512d ax = _mm512_loadu_pd(AX + p);
+		const __m512d ay = _mm512_loadu_pd(AY + p);
+		const __m512d az = _mm512_loadu_pd(AZ + p);
+		const __m512d bx = _mm512_loadu_pd(BX + p);
+		const __m512d by = _mm512_loadu_pd(BY + p);
+		const __m512d bz = _mm512_loadu_pd(BZ + p);
+
+		const __m512d sx = _mm512_sub_pd(bx, ax);
+		const __m512d sy = _mm512_sub_pd(by, ay);
+		const __m512d sz = _mm512_sub_pd(bz, az);
+		const __m512d d2 = _mm512_fmadd_pd(sz, sz, _mm512_fmadd_pd(sy, sy, _mm512_mul_pd(sx, sx)));
+
+		__mmask8 blocked = 0;
+
+		for (const FSimOccluder& Occluder : Occluders)
+		{
+			const __m512d cx = _mm512_set1_pd(Occluder.X);
+			const __m512d cy = _mm512_set1_pd(Occluder.Y);
+			const __m512d cz = _mm512_set1_pd(Occluder.Z);
+			const __m512d shell2 = _mm512_set1_pd(Occluder.Shell2);
+
+			const __m512d vx = _mm512_sub_pd(cx, ax);
+			const __m512d vy = _mm512_sub_pd(cy, ay);
+			const __m512d vz = _mm512_sub_pd(cz, az);
+			const __m512d d1 = _mm512_fmadd_pd(vz, sz, _mm512_fmadd_pd(vy, sy, _mm512_mul_pd(vx, sx)));
+
+			// closest point inside the segment
+			const __mmask8 inside = _mm512_cmp_pd_mask(d1, zero, _CMP_GT_OQ) & _mm512_cmp_pd_mask(d1, d2, _CMP_LT_OQ);
+			const __m512d t = _mm512_div_pd(d1, d2);
+			const __m512d mx = _mm512_fmsub_pd(sx, t, vx);
+			const __m512d my = _mm512_fmsub_pd(sy, t, vy);
+			const __m512d mz = _mm512_fmsub_pd(sz, t, vz);
+			const __m512d m2 = _mm512_fmadd_pd(mz, mz, _mm512_fmadd_pd(my, my, _mm512_mul_pd(mx, mx)));
+			const __mmask8 through = inside & _mm512_cmp_pd_mask(m2, shell2, _CMP_LT_OQ);
+
+			// closest at an end
+			const __mmask8 atFirst = _mm512_cmp_pd_mask(d1, zero, _CMP_LE_OQ);
+			const __m512d ux = _mm512_sub_pd(_mm512_mask_blend_pd(atFirst, bx, ax), cx);
+			const __m512d uy = _mm512_sub_pd(_mm512_mask_blend_pd(atFirst, by, ay), cy);
+			const __m512d uz = _mm512_sub_pd(_mm512_mask_blend_pd(atFirst, bz, az), cz);
+			const __m512d u2 = _mm512_fmadd_pd(uz, uz, _mm512_fmadd_pd(uy, uy, _mm512_mul_pd(ux, ux)));
+			const __m512d su = _mm512_fmadd_pd(sz, uz, _mm512_fmadd_pd(sy, uy, _mm512_mul_pd(sx, ux)));
+			const __m512d dot = _mm512_mask_blend_pd(atFirst, _mm512_sub_pd(zero, su), su);
+
+			const __mmask8 low = _mm512_cmp_pd_mask(dot, zero, _CMP_LE_OQ) |
+			                     _mm512_cmp_pd_mask(_mm512_mul_pd(dot, dot), _mm512_mul_pd(mask2, _mm512_mul_pd(d2, u2)), _CMP_LT_OQ);
+			const __mmask8 grazing = ~inside & _mm512_cmp_pd_mask(u2, shell2, _CMP_LT_OQ) & low;
+
+			blocked |= through | grazing;
+		}
+
+		const uint64 clear = static_cast<uint8>(~blocked);
+		OutClear[p / 64] |= clear << (p % 64);
+	}
+
+	SetClearAVX2(Occluders, AX, AY, AZ, BX, BY, BZ, p, End, OutClear);
+}
+
+#endif // PLATFORM_CPU_X86_FAMILY
+
+struct FOcclusionDispatch
+{
+	FOcclusionFunction Function = &SetClearScalar;
+	const TCHAR* InstructionSet = TEXT("Scalar");
+
+	FOcclusionDispatch()
+	{
+#if PLATFORM_CPU_X86_FAMILY
+		if (HasAVX512())
+		{
+			Function = &SetClearAVX512;
+			InstructionSet = TEXT("AVX-512");
+		}
+		else if (HasAVX2())
+		{
+			Function = &SetClearAVX2;
+			InstructionSet = TEXT("AVX2");
+		}
+#endif
+	}
+};
+
+static const FOcclusionDispatch& GetOcclusionDispatch()
+{
+	static const FOcclusionDispatch Dispatch;
+	return Dispatch;
+}
+
+void FSimOcclusionKernel::Test
+(
+	const TArray<FSimOccluder>& Occluders,
+	const double* AX, const double* AY, const double* AZ,
+	const double* BX, const double* BY, const double* BZ,
+	int32 Begin,
+	int32 End,
+	uint64* OutClear
+)
+{
+	ClearWords(Begin, End, OutClear);
+	GetOcclusionDispatch().Function(Occluders, AX, AY, AZ, BX, BY, BZ, Begin, End, OutClear);
+}
+
+const TCHAR* FSimOcclusionKernel::GetInstructionSet()
+{
+	return GetOcclusionDispatch().InstructionSet;
+}
@@ -0,0 +1,166 @@
+// DHmelevcev 2025
+
+#include "SimPhysicsThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "SimGameMode.h"
+
+FSimPhysicsThread::FSimPhysicsThread
+(
+	ASimGameMode* iGameMode,
+	bool bThreaded
+) :
+	GameMode(iGameMode)
+{
+	if (!bThreaded || !FPlatformProcess::SupportsMultithreading())
+		return;
+
+	PausedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	ResumeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+	Thread = FRunnableThread::Create(this, TEXT("OrbitSimPhysics"), 0, TPri_AboveNormal);
+}
+
+FSimPhysicsThread::~FSimPhysicsThread()
+{
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+	}
+
+	if (PausedEvent != nullptr)
+		FPlatformProcess::ReturnSynchEventToPool(PausedEvent);
+
+	if (ResumeEvent != nullptr)
+		FPlatformProcess::ReturnSynchEventToPool(ResumeEvent);
+}
+
+void FSimPhysicsThread::SetTarget
+(
+	const FDateTime& Target,
+	const FTimespan& PublishInterval
+)
+{
+	TargetTicks.store(Target.GetTicks(), std::memory_order_relaxed);
+	PublishTicks.store(PublishInterval.GetTicks(), std::memory_order_relaxed);
+}
+
+void FSimPhysicsThread::Pause()
+{
+	if (bPaused)
+		return;
+
+	bPauseRequested = true;
+
+	if (Thread != nullptr)
+		PausedEvent->Wait();
+
+	bPaused = true;
+}
+
+void FSimPhysicsThread::Resume
+(
+	int32 iDirection
+)
+{
+	Direction = iDirection;
+	PendingSteps = 0;
+	LastPublished = GameMode->Engine.UpdatedTo;
+
+	bPaused = false;
+	bPauseRequested = false;
+
+	if (Thread != nullptr)
+		ResumeEvent->Trigger();
+}
+
+void FSimPhysicsThread::Pump
+(
+	double BudgetSeconds
+)
+{
+	if (Thread != nullptr || bPaused)
+		return;
+
+	const double EndTime = FPlatformTime::Seconds() + BudgetSeconds;
+
+	while (Advance())
+	{
+		if (FPlatformTime::Seconds() < EndTime)
+			continue;
+
+		// show what was done this frame, continue next frame
+		if (PendingSteps > 0)
+			Publish();
+
+		break;
+	}
+}
+
+void FSimPhysicsThread::Publish()
+{
+	FSimSnapshot* Snapshot = Snapshots.BeginWrite();
+
+	// steps stay pending until the game thread frees a slot
+	if (Snapshot == nullptr)
+		return;
+
+	Snapshot->Write(GameMode->Engine.State, GameMode->Engine.UpdatedTo, PendingSteps);
+	Snapshots.EndWrite();
+
+	LastPublished = GameMode->Engine.UpdatedTo;
+	PendingSteps = 0;
+}
+
+bool FSimPhysicsThread::Advance()
+{
+	// never overwrite what the game thread has not shown yet
+	if (Snapshots.IsFull())
+		return false;
+
+	const int32 Steps = GameMode->StepSimulation(
+		FDateTime(TargetTicks.load(std::memory_order_relaxed)),
+		Direction.load(std::memory_order_relaxed));
+
+	PendingSteps += Steps;
+
+	if (PendingSteps > 0 &&
+		(Steps == 0 ||
+		 FMath::Abs((GameMode->Engine.UpdatedTo - LastPublished).GetTicks()) >=
+		 PublishTicks.load(std::memory_order_relaxed)))
+	{
+		Publish();
+	}
+
+	return Steps > 0;
+}
+
+uint32 FSimPhysicsThread::Run()
+{
+	while (!bStopRequested)
+	{
+		if (bPauseRequested)
+		{
+			PausedEvent->Trigger();
+			ResumeEvent->Wait();
+			continue;
+		}
+
+		if (!Advance())
+			FPlatformProcess::SleepNoStats(0.0005f);
+	}
+
+	return 0;
+}
+
+void FSimPhysicsThread::Stop()
+{
+	bStopRequested = true;
+
+	if (ResumeEvent != nullptr)
+		ResumeEvent->Trigger();
+}
@@ -0,0 +1,286 @@
+// DHmelevcev 2025
+
+#include "SimRouter.h"
+#include "SimLinkGraph.h"
+#include "SimLinkTracker.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+template <typename FunctionType>
+void FSimRouter::ForEachStation
+(
+	int32 NumStations,
+	const FunctionType& Function
+)
+{
+	const int32 NumTasks = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, FMath::Max(NumStations, 1));
+
+	if (Scratch.Num() < NumTasks)
+		Scratch.SetNum(NumTasks);
+
+	ParallelFor(NumTasks, [&](int32 Task)
+	{
+		for (int32 Station = Task; Station < NumStations; Station += NumTasks)
+			Function(Station, Scratch[Task]);
+	});
+}
+
+void FSimRouter::Update
+(
+	const FSimLinkTracker& Tracker
+)
+{
+	const FSimLinkInput& Input = Tracker.GetInput();
+	const TArray<FVector>& Nodes = Input.Nodes;
+
+	const int32 NumStations = Nodes.Num() - Input.NumSatellites;
+
+	const bool Rebuild = !Valid || Tracker.WasRebuilt() ||
+	                     Nodes.Num() != NumNodes || Input.NumSatellites != NumSatellites ||
+	                     FMath::Abs(Input.Time - RefreshTime) >= RefreshInterval;
+
+	if (Rebuild)
+	{
+		NumNodes = Nodes.Num();
+		NumSatellites = Input.NumSatellites;
+
+		Neighbours.SetNum(NumNodes);
+
+		for (auto& NodeNeighbours : Neighbours)
+			NodeNeighbours.Reset();
+
+		for (const FIntPoint& Link : Tracker.GetLinks())
+		{
+			Neighbours[Link.X].Emplace(Link.Y);
+			Neighbours[Link.Y].Emplace(Link.X);
+		}
+
+		Latencies.SetNumUninitialized(NumStations * NumNodes, false);
+		Parents.SetNumUninitialized(NumStations * NumNodes, false);
+
+		ForEachStation(NumStations, [&](int32 Station, FScratch& Memory)
+		{
+			BuildTree(Station, Nodes, Memory);
+		});
+
+		RefreshTime = Input.Time;
+		Valid = true;
+
+		return;
+	}
+
+	const TArray<FIntPoint>& Risen = Tracker.GetRisen();
+	const TArray<FIntPoint>& Set = Tracker.GetSet();
+
+	if (Risen.IsEmpty() && Set.IsEmpty())
+		return;
+
+	for (const FIntPoint& Link : Set)
+	{
+		Neighbours[Link.X].RemoveSingleSwap(Link.Y, false);
+		Neighbours[Link.Y].RemoveSingleSwap(Link.X, false);
+	}
+
+	for (const FIntPoint& Link : Risen)
+	{
+		Neighbours[Link.X].Emplace(Link.Y);
+		Neighbours[Link.Y].Emplace(Link.X);
+	}
+
+	ForEachStation(NumStations, [&](int32 Station, FScratch& Memory)
+	{
+		RepairTree(Station, Nodes, Risen, Set, Memory);
+	});
+}
+
+void FSimRouter::CopyRoutes
+(
+	FSimLinkGraph& Graph
+) const
+{
+	if (Valid && Graph.Num() == NumNodes && Graph.GetNumSatellites() == NumSatellites)
+		Graph.SetRoutes(Parents);
+}
+
+void FSimRouter::BuildTree
+(
+	int32 Station,
+	const TArray<FVector>& Nodes,
+	FScratch& Memory
+)
+{
+	double* Latency = &Latencies[Station * NumNodes];
+	int32* Parent = &Parents[Station * NumNodes];
+
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		Latency[i] = HUGE_VAL;
+		Parent[i] = INDEX_NONE;
+	}
+
+	const int32 Source = NumSatellites + Station;
+	Latency[Source] = 0;
+
+	Memory.Queue.Reset();
+	Memory.Queue.Emplace(FQueued{ 0, Source });
+
+	Relax(Station, Nodes, Memory.Queue);
+}
+
+void FSimRouter::RepairTree
+(
+	int32 Station,
+	const TArray<FVector>& Nodes,
+	const TArray<FIntPoint>& Risen,
+	const TArray<FIntPoint>& Set,
+	FScratch& Memory
+)
+{
+	double* Latency = &Latencies[Station * NumNodes];
+	int32* Parent = &Parents[Station * NumNodes];
+
+	TArray<FQueued>& Queue = Memory.Queue;
+	Queue.Reset();
+
+	// roots of subtrees that lost the link to their parent
+	TArray<int32>& Cut = Memory.Cut;
+	Cut.Reset();
+
+	for (const FIntPoint& Link : Set)
+	{
+		if (Parent[Link.Y] == Link.X)
+			Cut.Emplace(Link.Y);
+		else if (Parent[Link.X] == Link.Y)
+			Cut.Emplace(Link.X);
+	}
+
+	if (!Cut.IsEmpty())
+	{
+		// children of every node by counting sort of parents
+		TArray<int32>& First = Memory.First;
+		TArray<int32>& Children = Memory.Children;
+
+		First.Reset();
+		First.AddZeroed(NumNodes + 1);
+		Children.SetNumUninitialized(NumNodes, false);
+
+		for (int32 i = 0; i < NumNodes; ++i)
+			if (Parent[i] != INDEX_NONE)
+				++First[Parent[i] + 1];
+
+		for (int32 i = 0; i < NumNodes; ++i)
+			First[i + 1] += First[i];
+
+		for (int32 i = 0; i < NumNodes; ++i)
+			if (Parent[i] != INDEX_NONE)
+				Children[First[Parent[i]]++] = i;
+
+		// bounds moved up by one node while filling
+		for (int32 i = NumNodes; i > 0; --i)
+			First[i] = First[i - 1];
+
+		First[0] = 0;
+
+		// everything below a cut is unreachable until attached again,
+		// Cut is the stack of the walk
+		TArray<int32>& Detached = Memory.Detached;
+		Detached.Reset();
+
+		while (!Cut.IsEmpty())
+		{
+			const int32 Node = Cut.Pop(false);
+
+			if (Latency[Node] == HUGE_VAL)
+				continue;
+
+			Latency[Node] = HUGE_VAL;
+			Parent[Node] = INDEX_NONE;
+			Detached.Emplace(Node);
+
+			for (int32 k = First[Node]; k < First[Node + 1]; ++k)
+				Cut.Emplace(Children[k]);
+		}
+
+		// from the best neighbour still attached
+		for (int32 Node : Detached)
+		{
+			for (int32 Neighbour : Neighbours[Node])
+			{
+				const double Candidate = Latency[Neighbour] + FVector::Dist(Nodes[Node], Nodes[Neighbour]) / SpeedOfLight;
+
+				if (Candidate < Latency[Node])
+				{
+					Latency[Node] = Candidate;
+					Parent[Node] = Neighbour;
+				}
+			}
+
+			if (Latency[Node] < HUGE_VAL)
+				Queue.Emplace(FQueued{ Latency[Node], Node });
+		}
+	}
+
+	// a risen link may shorten routes on either side
+	for (const FIntPoint& Link : Risen)
+	{
+		const double Hop = FVector::Dist(Nodes[Link.X], Nodes[Link.Y]) / SpeedOfLight;
+
+		for (int32 End = 0; End < 2; ++End)
+		{
+			const int32 From = End ? Link.Y : Link.X;
+			const int32 To = End ? Link.X : Link.Y;
+
+			if (Latency[From] + Hop < Latency[To])
+			{
+				Latency[To] = Latency[From] + Hop;
+				Parent[To] = From;
+
+				Queue.Emplace(FQueued{ Latency[To], To });
+			}
+		}
+	}
+
+	Relax(Station, Nodes, Queue);
+}
+
+void FSimRouter::Relax
+(
+	int32 Station,
+	const TArray<FVector>& Nodes,
+	TArray<FQueued>& Queue
+)
+{
+	double* Latency = &Latencies[Station * NumNodes];
+	int32* Parent = &Parents[Station * NumNodes];
+
+	auto Earlier = [](const FQueued& A, const FQueued& B)
+	{
+		return A.Latency < B.Latency;
+	};
+
+	// seeds come unordered
+	Queue.Heapify(Earlier);
+
+	while (!Queue.IsEmpty())
+	{
+		FQueued Top;
+		Queue.HeapPop(Top, Earlier, false);
+
+		// a shorter route reached the node since it was queued
+		if (Top.Latency > Latency[Top.Node])
+			continue;
+
+		for (int32 Neighbour : Neighbours[Top.Node])
+		{
+			const double Candidate = Top.Latency + FVector::Dist(Nodes[Top.Node], Nodes[Neighbour]) / SpeedOfLight;
+
+			if (Candidate < Latency[Neighbour])
+			{
+				Latency[Neighbour] = Candidate;
+				Parent[Neighbour] = Top.Node;
+
+				Queue.HeapPush(FQueued{ Candidate, Neighbour }, Earlier);
+			}
+		}
+	}
+}
@@ -2,6 +2,7 @@
 
 #include "SimSignalHandler.h"
 #include "Components/LineBatchComponent.h"
+#include "Async/Async.h"
 #include "SimCelestialBody.h"
 #include "SimBody.h"
 #include "SimBaseStation.h"
@@ -14,35 +15,52 @@ ASimSignalHandler::ASimSignalHandler()
 
     LineBatchComponent = CreateDefaultSubobject<ULineBatchComponent>(TEXT("LineBatcher"));
     LineBatchComponent->SetupAttachment(RootComponent);
-}
-
-bool ASimSignalHandler::HasCollisions(const FVector& firstPos, const FVector& secondPos) {
-    if (!CelestialBodies)
-        return false;
 
-    for (size_t k = 0; k < CelestialBodies->Num(); ++k) {
-        const FVector& o = (*CelestialBodies)[k]->Position;
+    LinkTracker = MakeShared<FSimLinkTracker, ESPMode::ThreadSafe>();
+    Router = MakeShared<FSimRouter, ESPMode::ThreadSafe>();
+    LinkInput = MakeShared<FSimLinkInput, ESPMode::ThreadSafe>();
+}
 
-        FVector m = FMath::ClosestPointOnSegment(o, firstPos, secondPos);
-        
-        // closest point inside sphere?
-        if ((m - o).SizeSquared() < pow((*CelestialBodies)[k]->Radius * 1010, 2)) {
-            if (m != firstPos && m != secondPos) // closest point at start -> station - satellite connection
-                return true;
+void ASimSignalHandler::GatherLinkInput(FSimLinkInput& Input) {
+    Input.Time = WorldTime ? (*WorldTime - FDateTime(2000, 1, 1)).GetTotalSeconds() : 0;
+    Input.NumSatellites = PhysicBodies->Num();
+    Input.MaxDistance = MaxLinkDistance * 1e3;
+    Input.Nodes.Reset(PhysicBodies->Num() + BaseStations->Num());
+    Input.Speeds.Reset(PhysicBodies->Num() + BaseStations->Num());
+    Input.Occluders.Reset();
+    Input.OccluderRadii.Reset();
+    Input.OccluderSpeeds.Reset();
+    PendingNodes.Reset(PhysicBodies->Num() + BaseStations->Num());
 
-            const FVector& r = m == firstPos ? secondPos : firstPos;
+    for (ASimBody* body : *PhysicBodies) {
+        PendingNodes.Emplace(body);
+        Input.Nodes.Emplace(body->Position);
+        Input.Speeds.Emplace(body->Velocity.Length());
+    }
 
-            FVector d = r - m;
-            d.Normalize();
-            m -= o;
-            m.Normalize();
+    for (ASimBaseStation* station : *BaseStations) {
+        PendingNodes.Emplace(station);
+        Input.Nodes.Emplace(station->GetActorLocation() / 100);
 
-            if (d.Dot(m) < 0.087155742) // arcsin(5deg)
-                return true;
+        // carried by its body and turned with it
+        const ASimCelestialBody* body = station->CelestialBody;
+        double speed = 0;
+        if (body) {
+            speed = body->Velocity.Length();
+            if (body->SiderealRotationPeriod)
+                speed += 2 * PI * body->Radius * 1e3 / FMath::Abs(body->SiderealRotationPeriod);
         }
+        Input.Speeds.Emplace(speed);
     }
 
-    return false;
+    if (!CelestialBodies)
+        return;
+
+    for (const ASimCelestialBody* body : *CelestialBodies) {
+        Input.Occluders.Emplace(body->Position);
+        Input.OccluderRadii.Emplace(body->Radius * 1e3);
+        Input.OccluderSpeeds.Emplace(body->Velocity.Length());
+    }
 }
 
 void ASimSignalHandler::Tick(float DeltaTime)
@@ -52,10 +70,54 @@ void ASimSignalHandler::Tick(float DeltaTime)
     if (!PhysicBodies || !BaseStations)
         return;
 
-    size_t numB = BaseStations->Num();
+    // links are updated on worker threads, one graph at a time,
+    // only pairs whose predicted rise or set is due are tested
+    if (PendingLinkGraph.IsValid() && PendingLinkGraph.IsReady()) {
+        TSharedPtr<const FSimLinkGraph, ESPMode::ThreadSafe> previous = MoveTemp(LinkGraph);
+        LinkGraph = PendingLinkGraph.Consume();
+
+        // only this handler built it, nobody reads it any more
+        if (previous.IsUnique())
+            SpareLinkGraph = ConstCastSharedPtr<FSimLinkGraph>(previous);
+
+        Swap(GraphNodes, PendingNodes);
+        LinesDirty = true;
+    }
+
+    const FDateTime time = WorldTime ? *WorldTime : FDateTime();
+
+    // bodies stand still and none were added
+    if (time == LinesTime && !LinesDirty &&
+        (!LinkGraph || LinkGraph->Num() == PhysicBodies->Num() + BaseStations->Num()))
+        return;
+
+    if (!PendingLinkGraph.IsValid()) {
+        GatherLinkInput(*LinkInput);
+
+        LinkTracker->VectorizedOcclusion = VectorizedOcclusion;
+        Router->RefreshInterval = RouteRefreshInterval;
+
+        TSharedPtr<FSimLinkGraph, ESPMode::ThreadSafe> graph = SpareLinkGraph ?
+            MoveTemp(SpareLinkGraph) : MakeShared<FSimLinkGraph, ESPMode::ThreadSafe>();
+
+        // routes follow the links the tracker has just changed
+        PendingLinkGraph = Async(EAsyncExecution::ThreadPool, [tracker = LinkTracker, router = Router, input = LinkInput, graph]() {
+            tracker->Update(*input);
+            router->Update(*tracker);
+
+            tracker->CopyLinks(*graph);
+            router->CopyRoutes(*graph);
+
+            return TSharedPtr<const FSimLinkGraph, ESPMode::ThreadSafe>(graph);
+        });
+    }
+
+    LinesTime = time;
+    LinesDirty = false;
+
+    FindVisibleTerminals();
+
     size_t numP = PhysicBodies->Num();
-    size_t numSum = static_cast<size_t>(numB + numP);
-    Distances.SetNum(pow(numSum, 2));
 
     size_t signalCnt = 0;
 
@@ -72,43 +134,123 @@ void ASimSignalHandler::Tick(float DeltaTime)
         ++signalCnt;
     }
 
-    // TODO: parallelable
-    //for (size_t i = 0; i < numSum; ++i) {
-    //    const FVector& firstPos = i >= numP ? (*BaseStations)[i - numP]->GetActorLocation() / 100 :
-    //                                          (*PhysicBodies)[i]->Position;
+    // links of the last complete graph, at positions it was built from
+    const int32 numNodes = LinkGraph ? LinkGraph->Num() : 0;
 
-    //    for (size_t j = i + 1; j < numSum; ++j) {
-    //        const FVector& secondPos = j >= numP ? (*BaseStations)[j - numP]->GetActorLocation() / 100 :
-    //                                               (*PhysicBodies)[j]->Position;
+    for (int32 i = 0; i < numNodes; ++i) {
+        for (int32 j : LinkGraph->GetLinks(i)) {
+            if (LineBatchComponent->BatchedLines.Num() < signalCnt + 1)
+                LineBatchComponent->BatchedLines.Emplace();
 
-    //        Distances[i * numSum + j] = HasCollisions(firstPos, secondPos) ? HUGE_VAL :
-    //                                                                         (secondPos - firstPos).Length();
+            FBatchedLine& line = LineBatchComponent->BatchedLines[signalCnt];
+            line.Start = LinkGraph->GetPosition(i) * 100;
+            line.End = LinkGraph->GetPosition(j) * 100;
+            line.Color = FLinearColor(FVector::OneVector * 1);
 
-    //        //Distances[j * numSum + i] = Distances[i * numSum + j];
+            ++signalCnt;
+        }
+    }
 
-    //        if (Distances[i * numSum + j] < HUGE_VAL) {
-    //            if (LineBatchComponent->BatchedLines.Num() < signalCnt + 1)
-    //                LineBatchComponent->BatchedLines.Emplace();
+    // lines are kept for the next frames
+    LineBatchComponent->BatchedLines.SetNum(signalCnt, false);
+    LineBatchComponent->MarkRenderStateDirty();
+}
 
-    //            FBatchedLine& line = LineBatchComponent->BatchedLines[signalCnt];
-    //            line.Start = firstPos * 100;
-    //            line.End = secondPos * 100;
-    //            line.Color = FLinearColor(FVector::OneVector * 1); //
+void ASimSignalHandler::FindVisibleTerminals()
+{
+    VisibleFirst.Reset();
+    VisibleTerminals.Reset();
 
-    //            ++signalCnt;
-    //        }
-    //    }
-    //}
+    if (!Terminals.Num() || !CelestialBodies || CelestialBodies->IsEmpty())
+        return;
 
-    LineBatchComponent->BatchedLines.SetNum(signalCnt);
-    LineBatchComponent->MarkRenderStateDirty();
+    // terminals turn with the body as base stations do
+    const ASimCelestialBody* body = (*CelestialBodies)[0];
+    const double rotation = body->StaticMesh->GetRelativeRotation().Yaw;
+
+    TerminalQuery.Reset(PhysicBodies->Num());
+
+    for (const ASimBody* physic : *PhysicBodies)
+        TerminalQuery.Emplace(physic->Position - body->Position);
+
+    Terminals.FindVisible(TerminalQuery, body->Radius, rotation, VisibleFirst, VisibleTerminals);
+}
+
+int32 ASimSignalHandler::AddGroundTerminal(double Latitude, double Longitude) {
+    LinesDirty = true;
+
+    return Terminals.Add(Latitude, Longitude);
+}
+
+void ASimSignalHandler::ClearGroundTerminals() {
+    LinesDirty = true;
+
+    Terminals.Reset();
+}
+
+TArray<int32> ASimSignalHandler::GetVisibleTerminals(const ASimBody* Body) const {
+    TArray<int32> terminals;
+
+    const int32 index = PhysicBodies && Body ? PhysicBodies->IndexOfByKey(Body) : INDEX_NONE;
+
+    // bodies added after the last query are not in it yet
+    if (index == INDEX_NONE || index + 1 >= VisibleFirst.Num())
+        return terminals;
+
+    terminals.Append(VisibleTerminals.GetData() + VisibleFirst[index], VisibleFirst[index + 1] - VisibleFirst[index]);
+
+    return terminals;
+}
+
+int32 ASimSignalHandler::GetNumVisibleTerminals() const {
+    return VisibleTerminals.Num();
+}
+
+int32 ASimSignalHandler::FindNode(const AActor* Actor) const {
+    if (!LinkGraph || Actor == nullptr)
+        return INDEX_NONE;
+
+    return GraphNodes.IndexOfByPredicate([Actor](const TWeakObjectPtr<AActor>& node) {
+        return node.Get() == Actor;
+    });
+}
+
+double ASimSignalHandler::GetLatency(const ASimBaseStation* From, const AActor* To) const {
+    const int32 from = FindNode(From);
+    const int32 to = FindNode(To);
+
+    if (from == INDEX_NONE || to == INDEX_NONE)
+        return -1;
+
+    return LinkGraph->GetLatency(from - LinkGraph->GetNumSatellites(), to);
+}
+
+TArray<AActor*> ASimSignalHandler::GetRoute(const ASimBaseStation* From, const AActor* To) const {
+    TArray<AActor*> route;
+
+    const int32 from = FindNode(From);
+    const int32 to = FindNode(To);
+
+    if (from == INDEX_NONE || to == INDEX_NONE)
+        return route;
+
+    TArray<int32> path;
+    LinkGraph->GetPath(from - LinkGraph->GetNumSatellites(), to, path);
+
+    for (int32 node : path)
+        route.Emplace(GraphNodes[node].Get());
+
+    return route;
 }
 
 void ASimSignalHandler::SetContext(TArray<ASimBody*>& iPhysicBodies,
                                    TArray<ASimCelestialBody*>& iCelestialBodies,
-                                   TArray<ASimBaseStation*>& iBaseStations)
+                                   TArray<ASimBaseStation*>& iBaseStations,
+                                   const FDateTime& iWorldTime)
 {
     PhysicBodies = &iPhysicBodies;
     CelestialBodies = &iCelestialBodies;
     BaseStations = &iBaseStations;
+    WorldTime = &iWorldTime;
+    LinesDirty = true;
 }
@@ -0,0 +1,73 @@
+// DHmelevcev 2025
+
+#include "SimSnapshot.h"
+
+void FSimSnapshot::Write
+(
+	const FSimStateStore& State,
+	const FDateTime& iTime,
+	int32 iSteps
+)
+{
+	Time = iTime;
+	Steps = iSteps;
+
+	// same size after the first write, arrays keep their allocation
+	Position.X = State.Position.X;
+	Position.Y = State.Position.Y;
+	Position.Z = State.Position.Z;
+
+	Velocity.X = State.Velocity.X;
+	Velocity.Y = State.Velocity.Y;
+	Velocity.Z = State.Velocity.Z;
+}
+
+void FSimSnapshot::Read
+(
+	FSimStateStore& State
+) const
+{
+	check(Position.X.Num() == State.Num());
+
+	State.Position.X = Position.X;
+	State.Position.Y = Position.Y;
+	State.Position.Z = Position.Z;
+
+	State.Velocity.X = Velocity.X;
+	State.Velocity.Y = Velocity.Y;
+	State.Velocity.Z = Velocity.Z;
+}
+
+void FSimSnapshot::Interpolate
+(
+	const FSimSnapshot& A,
+	const FSimSnapshot& B,
+	double Alpha,
+	int32 Index,
+	FVector& OutPosition,
+	FVector& OutVelocity
+)
+{
+	const double h = (B.Time - A.Time).GetTotalSeconds();
+
+	const FVector P0 = A.Position.Get(Index);
+	const FVector P1 = B.Position.Get(Index);
+	const FVector V0 = A.Velocity.Get(Index) * h;
+	const FVector V1 = B.Velocity.Get(Index) * h;
+
+	const double s = Alpha;
+	const double s2 = s * s;
+	const double s3 = s2 * s;
+
+	OutPosition = (2 * s3 - 3 * s2 + 1) * P0 +
+	              (s3 - 2 * s2 + s) * V0 +
+	              (3 * s2 - 2 * s3) * P1 +
+	              (s3 - s2) * V1;
+
+	const FVector Derivative = (6 * s2 - 6 * s) * P0 +
+	                           (3 * s2 - 4 * s + 1) * V0 +
+	                           (6 * s - 6 * s2) * P1 +
+	                           (3 * s2 - 2 * s) * V1;
+
+	OutVelocity = h != 0 ? Derivative / h : A.Velocity.Get(Index);
+}
@@ -0,0 +1,139 @@
+// DHmelevcev 2025
+
+#include "SimStateStore.h"
+#include "SimBody.h"
+#include "SimCelestialBody.h"
+
+void FSimVectorColumn::SetNum(int32 Num)
+{
+	X.SetNumUninitialized(Num);
+	Y.SetNumUninitialized(Num);
+	Z.SetNumUninitialized(Num);
+}
+
+void FSimStateStore::SetNum
+(
+	int32 iNumCelestial,
+	int32 iNumPhysic,
+	int32 iNumAnalytic
+)
+{
+	NumCelestial = iNumCelestial;
+	NumPhysic = iNumPhysic;
+	NumAnalytic = iNumAnalytic;
+
+	const int32 NumAll = Num();
+
+	Position.SetNum(NumAll);
+	Velocity.SetNum(NumAll);
+
+	for (int32 k = 0; k < 4; ++k)
+	{
+		P[k].SetNum(NumAll);
+		V[k].SetNum(NumAll);
+		A[k].SetNum(NumAll);
+	}
+
+	GM.SetNumUninitialized(NumCelestial);
+	J2.SetNumUninitialized(NumCelestial);
+	Radius.SetNumUninitialized(NumCelestial);
+	RotationPeriod.SetNumUninitialized(NumCelestial);
+}
+
+void FSimStateStore::Gather
+(
+	const TArray<ASimCelestialBody*>& CelestialBodies,
+	const TArray<ASimBody*>& PhysicBodies,
+	int32 iNumAnalytic
+)
+{
+	SetNum(CelestialBodies.Num(), PhysicBodies.Num() - iNumAnalytic, iNumAnalytic);
+
+	for (int32 i = 0; i < NumCelestial; ++i)
+	{
+		const ASimCelestialBody& body = *CelestialBodies[i];
+
+		Position.Set(i, body.Position);
+		Velocity.Set(i, body.Velocity);
+
+		GM[i] = body.GM;
+		J2[i] = body.J2;
+		Radius[i] = body.Radius;
+		RotationPeriod[i] = body.SiderealRotationPeriod;
+	}
+
+	for (int32 i = 0; i < PhysicBodies.Num(); ++i)
+	{
+		const ASimBody& body = *PhysicBodies[i];
+
+		Position.Set(NumCelestial + i, body.Position);
+		Velocity.Set(NumCelestial + i, body.Velocity);
+	}
+}
+
+void FSimStateStore::CopyCelestial
+(
+	const FSimStateStore& State
+)
+{
+	const int32 NumC = State.NumCelestial;
+
+	SetNum(NumC, 0, 0);
+
+	GM = State.GM;
+	J2 = State.J2;
+	Radius = State.Radius;
+	RotationPeriod = State.RotationPeriod;
+
+	for (int32 i = 0; i < NumC; ++i)
+	{
+		Position.Set(i, State.Position.Get(i));
+		Velocity.Set(i, State.Velocity.Get(i));
+	}
+}
+
+void FSimStateStore::Scatter
+(
+	const TArray<ASimCelestialBody*>& CelestialBodies,
+	const TArray<ASimBody*>& PhysicBodies
+)
+const
+{
+	check(CelestialBodies.Num() == NumCelestial);
+	check(PhysicBodies.Num() == NumPhysic + NumAnalytic);
+
+	for (int32 i = 0; i < NumCelestial; ++i)
+	{
+		CelestialBodies[i]->Position = Position.Get(i);
+		CelestialBodies[i]->Velocity = Velocity.Get(i);
+	}
+
+	for (int32 i = 0; i < PhysicBodies.Num(); ++i)
+	{
+		PhysicBodies[i]->Position = Position.Get(NumCelestial + i);
+		PhysicBodies[i]->Velocity = Velocity.Get(NumCelestial + i);
+	}
+}
+
+void FSimStateStore::ClearBuffers()
+{
+	for (int32 k = 0; k < 4; ++k)
+		ClearBuffer(k);
+}
+
+void FSimStateStore::ClearBuffer(int32 Stage)
+{
+	const SIZE_T Bytes = Num() * sizeof(double);
+
+	FMemory::Memcpy(P[Stage].X.GetData(), Position.X.GetData(), Bytes);
+	FMemory::Memcpy(P[Stage].Y.GetData(), Position.Y.GetData(), Bytes);
+	FMemory::Memcpy(P[Stage].Z.GetData(), Position.Z.GetData(), Bytes);
+
+	FMemory::Memcpy(V[Stage].X.GetData(), Velocity.X.GetData(), Bytes);
+	FMemory::Memcpy(V[Stage].Y.GetData(), Velocity.Y.GetData(), Bytes);
+	FMemory::Memcpy(V[Stage].Z.GetData(), Velocity.Z.GetData(), Bytes);
+
+	FMemory::Memzero(A[Stage].X.GetData(), Bytes);
+	FMemory::Memzero(A[Stage].Y.GetData(), Bytes);
+	FMemory::Memzero(A[Stage].Z.GetData(), Bytes);
+}
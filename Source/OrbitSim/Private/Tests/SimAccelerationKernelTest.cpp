@@ -0,0 +1,69 @@
+// DHmelevcev 2025
+
+#include "Misc/AutomationTest.h"
+#include "SimAccelerationKernel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimAccelerationKernelTest, "OrbitSim.Kernels.Acceleration",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimAccelerationKernelTest::RunTest(const FString& Parameters)
+{
+	// Earth and bodies from LEO to GEO on inclined orbits,
+	// count is not a multiple of the vector width to cover the tail
+	constexpr int32 Num = 1021;
+
+	const FSimAttractor Earth = FSimAccelerationKernel::MakeAttractor(0, 0, 0, 398600441800000., 0.00108262668, 6371.);
+
+	TArray<double> PX, PY, PZ;
+	TArray<double> AX, AY, AZ;
+	TArray<double> RefX, RefY, RefZ;
+
+	for (auto* Column : { &PX, &PY, &PZ })
+		Column->SetNumUninitialized(Num);
+	for (auto* Column : { &AX, &AY, &AZ, &RefX, &RefY, &RefZ })
+		Column->SetNumZeroed(Num);
+
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const double Distance = 1000. * FMath::Lerp(6600., 42164., double(i) / Num);
+		const double Longitude = 0.37 * i;
+		const double Latitude = FMath::Sin(0.11 * i) * 1.4;
+
+		PX[i] = Distance * FMath::Cos(Latitude) * FMath::Cos(Longitude);
+		PY[i] = Distance * FMath::Cos(Latitude) * FMath::Sin(Longitude);
+		PZ[i] = Distance * FMath::Sin(Latitude);
+	}
+
+	// a range starting off the vector width, accumulated
+	// twice to check that accelerations are added to
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		FSimAccelerationKernel::Accumulate(Earth, PX.GetData(), PY.GetData(), PZ.GetData(),
+		                                   AX.GetData(), AY.GetData(), AZ.GetData(), 3, Num);
+		FSimAccelerationKernel::AccumulateScalar(Earth, PX.GetData(), PY.GetData(), PZ.GetData(),
+		                                         RefX.GetData(), RefY.GetData(), RefZ.GetData(), 3, Num);
+	}
+
+	for (int32 i = 0; i < 3; ++i)
+		TestTrue(TEXT("Bodies before Begin are untouched"), AX[i] == 0 && AY[i] == 0 && AZ[i] == 0);
+
+	double MaxError = 0;
+	for (int32 i = 3; i < Num; ++i)
+	{
+		const FVector Reference(RefX[i], RefY[i], RefZ[i]);
+		const FVector Difference = FVector(AX[i], AY[i], AZ[i]) - Reference;
+
+		MaxError = FMath::Max(MaxError, Difference.Size() / Reference.Size());
+	}
+
+	AddInfo(FString::Printf(TEXT("%s kernel, largest relative difference %g"),
+	                        FSimAccelerationKernel::GetInstructionSet(), MaxError));
+
+	TestTrue(TEXT("Accumulate matches AccumulateScalar within 1e-12"), MaxError <= 1e-12);
+
+	return true;
+}
+
+#endif
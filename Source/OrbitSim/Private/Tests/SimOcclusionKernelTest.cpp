@@ -0,0 +1,103 @@
+// DHmelevcev 2025
+
+#include "Misc/AutomationTest.h"
+#include "SimOcclusionKernel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimOcclusionKernelTest, "OrbitSim.Kernels.Occlusion",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimOcclusionKernelTest::RunTest(const FString& Parameters)
+{
+	constexpr double EarthRadius = 6371e3;
+	constexpr double MoonRadius = 1737.4e3;
+	const FVector Moon(384400e3, 0, 0);
+
+	const TArray<FSimOccluder> Occluders = {
+		FSimOcclusionKernel::MakeOccluder(FVector::ZeroVector, EarthRadius),
+		FSimOcclusionKernel::MakeOccluder(Moon, MoonRadius)
+	};
+
+	// evenly spread points of a sphere, golden angle spiral
+	auto Spiral = [](int32 i, int32 Num, double Distance)
+	{
+		const double Z = 1 - (2 * i + 1.) / Num;
+		const double Ring = FMath::Sqrt(1 - Z * Z);
+		const double Angle = i * PI * (3 - FMath::Sqrt(5.));
+
+		return FVector(Ring * FMath::Cos(Angle), Ring * FMath::Sin(Angle), Z) * Distance;
+	};
+
+	TArray<FVector> Nodes;
+
+	// stations on both bodies, inside the shells
+	for (int32 i = 0; i < 40; ++i)
+		Nodes.Emplace(Spiral(i, 40, EarthRadius));
+	for (int32 i = 0; i < 8; ++i)
+		Nodes.Emplace(Moon + Spiral(i, 8, MoonRadius));
+
+	// LEO, MEO and GEO shells
+	for (const double Distance : { 7000e3, 26560e3, 42164e3 })
+		for (int32 i = 0; i < 37; ++i)
+			Nodes.Emplace(Spiral(i, 37, Distance));
+
+	TArray<double> AX, AY, AZ, BX, BY, BZ;
+
+	auto AddSegment = [&](const FVector& A, const FVector& B)
+	{
+		AX.Emplace(A.X); AY.Emplace(A.Y); AZ.Emplace(A.Z);
+		BX.Emplace(B.X); BY.Emplace(B.Y); BZ.Emplace(B.Z);
+	};
+
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+		for (int32 j = i + 1; j < Nodes.Num(); ++j)
+			AddSegment(Nodes[i], Nodes[j]);
+
+	// segments grazing the Earth shell from both sides and stations
+	// seeing satellites right at the elevation mask
+	const double Shell = EarthRadius * 1.01;
+	for (const double Offset : { -1., 1. })
+	{
+		AddSegment(FVector(-20000e3, Shell + Offset, 0), FVector(20000e3, Shell + Offset, 0));
+
+		const double Mask = FMath::DegreesToRadians(5.) + Offset * 1e-9;
+		const FVector Up(0, 0, EarthRadius);
+		AddSegment(Up, Up + FVector(FMath::Cos(Mask), 0, FMath::Sin(Mask)) * 1000e3);
+	}
+
+	// the tested range starts past the first word and
+	// ends inside the last one to cover the tail
+	const int32 Begin = 64;
+	const int32 Num = AX.Num();
+	TestTrue(TEXT("Segment count is not a multiple of the word size"), Num % 64 != 0);
+
+	TArray<uint64> Clear, Reference;
+	Clear.Init(~uint64(0), (Num + 63) / 64);
+	Reference.Init(~uint64(0), (Num + 63) / 64);
+
+	FSimOcclusionKernel::Test(Occluders, AX.GetData(), AY.GetData(), AZ.GetData(),
+	                          BX.GetData(), BY.GetData(), BZ.GetData(), Begin, Num, Clear.GetData());
+	FSimOcclusionKernel::TestScalar(Occluders, AX.GetData(), AY.GetData(), AZ.GetData(),
+	                                BX.GetData(), BY.GetData(), BZ.GetData(), Begin, Num, Reference.GetData());
+
+	TestEqual(TEXT("Words before Begin are untouched"), Clear[0], ~uint64(0));
+
+	int32 NumDifferent = 0;
+	int32 NumClear = 0;
+	for (int32 w = 1; w < Clear.Num(); ++w)
+	{
+		NumDifferent += FMath::CountBits(Clear[w] ^ Reference[w]);
+		NumClear += FMath::CountBits(Reference[w]);
+	}
+
+	AddInfo(FString::Printf(TEXT("%s kernel, %d of %d segments clear"),
+	                        FSimOcclusionKernel::GetInstructionSet(), NumClear, Num - Begin));
+
+	TestTrue(TEXT("Fixture has both clear and blocked segments"), NumClear > 0 && NumClear < Num - Begin);
+	TestEqual(TEXT("Test matches TestScalar on every segment"), NumDifferent, 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,28 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OrbitSimBatchCommandlet.generated.h"
+
+// Propagates a scenario file without a level or rendering as fast as
+// the CPU allows, writes final states and optionally the coverage map.
+//
+// UnrealEditor-Cmd OrbitSim.uproject -run=OrbitSimBatch scenario.json
+//     --until=<ISO 8601 time | duration like 30d, 12h, 90m or seconds>
+//     [--from=<ISO 8601 time>] [--out=<file.json>]
+//     [--coverage] [--sample=<seconds between coverage samples>]
+//
+// Celestial bodies come from "CelestialBodies" of the scenario,
+// Earth alone is simulated without them.
+UCLASS()
+class ORBITSIM_API UOrbitSimBatchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOrbitSimBatchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
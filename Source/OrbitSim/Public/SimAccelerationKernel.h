@@ -0,0 +1,59 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// celestial body as seen by acceleration kernels
+struct FSimAttractor
+{
+	// in m
+	double X = 0;
+	double Y = 0;
+	double Z = 0;
+
+	// Standard gravitational parameter (m^3 / s^2)
+	double GM = 0;
+
+	// 1.5 * J2 * GM * Radius^2 with Radius in m, zero disables J2
+	double J2Factor = 0;
+};
+
+// Point mass and J2 acceleration of physic bodies towards one celestial body.
+// Bodies are addressed by index range [Begin, End) in position and
+// acceleration columns, accelerations are accumulated.
+struct ORBITSIM_API FSimAccelerationKernel
+{
+	static FSimAttractor MakeAttractor
+	(
+		double X,
+		double Y,
+		double Z,
+		double GM,
+		double J2,
+		double Radius // km
+	);
+
+	// widest instruction set supported by this CPU
+	static void Accumulate
+	(
+		const FSimAttractor& Attractor,
+		const double* PX, const double* PY, const double* PZ,
+		double* AX, double* AY, double* AZ,
+		int32 Begin,
+		int32 End
+	);
+
+	// reference implementation
+	static void AccumulateScalar
+	(
+		const FSimAttractor& Attractor,
+		const double* PX, const double* PY, const double* PZ,
+		double* AX, double* AY, double* AZ,
+		int32 Begin,
+		int32 End
+	);
+
+	// name of the instruction set used by Accumulate
+	static const TCHAR* GetInstructionSet();
+};
@@ -0,0 +1,139 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimAnalyticPropagator.h"
+
+// ground station as seen by FSimAccessPlanner
+struct FSimAccessStation
+{
+	// store index of the celestial body it stands on
+	int32 Body = 0;
+
+	// in deg.
+	double Latitude = 0;
+	double Longitude = 0;
+};
+
+// pass of a satellite above the elevation mask of a station,
+// times are seconds after the start of planning
+struct FSimAccessWindow
+{
+	int32 Station = 0;
+
+	// physic body index, store index minus the number of celestial bodies
+	int32 Satellite = 0;
+
+	// acquisition and loss of signal, clipped to the planned span
+	double Rise = 0;
+	double Set = 0;
+
+	// time of the highest elevation (deg.)
+	double Culmination = 0;
+	double MaxElevation = 0;
+
+	FORCEINLINE double GetDuration() const
+	{
+		return Set - Rise;
+	}
+};
+
+// Access windows of every station and satellite pair over a span of time,
+// without stepping the simulation. Satellites follow two-body orbits with
+// secular J2 drift around the body of a station, stations turn with it.
+// Elevation changes no faster than the line of sight turns, so it is
+// evaluated only once it could have reached the mask, rises and sets are
+// found by bisection and culminations by golden section search.
+// Pairs are planned in parallel.
+class ORBITSIM_API FSimAccessPlanner
+{
+public:
+	// lowest elevation (deg.) a satellite is seen at, the same as for links
+	double MinElevation = 5;
+
+	// of rise, set and culmination times (s)
+	double Tolerance = 1e-3;
+
+	// shortest step (s) between elevations, passes above
+	// the mask for less than it may be missed
+	double MinStep = 1;
+
+	// longest step (s) between elevations
+	double MaxStep = 600;
+
+	// satellites are physic bodies of State at Start
+	void Reset
+	(
+		const FSimStateStore& State,
+		const FDateTime& Start,
+		const TArray<FSimAccessStation>& iStations
+	);
+
+	// windows within Duration (s) after Start ordered by station, satellite and rise
+	void Compute(double Duration, TArray<FSimAccessWindow>& OutWindows) const;
+
+	FORCEINLINE int32 GetNumSatellites() const
+	{
+		return NumSatellites;
+	}
+
+private:
+	struct FSatellite
+	{
+		FSimKeplerOrbit Orbit;
+
+		// fastest speed (m / s) and lowest altitude (m) of the orbit
+		double MaxSpeed = 0;
+		double MinAltitude = 0;
+
+		bool Valid = false;
+	};
+
+	struct FBody
+	{
+		// in m
+		double Radius = 0;
+
+		// angle (rad) of the body at Start and its rate (rad / s)
+		double Angle = 0;
+		double Spin = 0;
+
+		// around this body, only for bodies with stations
+		TArray<FSatellite> Satellites;
+	};
+
+	struct FStation
+	{
+		int32 Body = 0;
+
+		double SinLatitude = 0;
+		double CosLatitude = 0;
+
+		// angle (rad) from the body angle
+		double Azimuth = 0;
+	};
+
+	// by celestial body index
+	TArray<FBody> Bodies;
+	TArray<FStation> Stations;
+
+	int32 NumSatellites = 0;
+
+	// elevation (rad) of a satellite and its distance (m) Time seconds after Start
+	double GetElevation
+	(
+		const FStation& Station,
+		const FSatellite& Satellite,
+		double Time,
+		double& OutRange
+	) const;
+
+	void ComputePair
+	(
+		int32 Station,
+		int32 Satellite,
+		double Duration,
+		TArray<FSimAccessWindow>& OutWindows
+	) const;
+};
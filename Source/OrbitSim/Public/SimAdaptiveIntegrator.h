@@ -0,0 +1,160 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimAccelerationKernel.h"
+#include "SimStateStore.h"
+
+// error control of adaptive integration
+struct FSimAdaptiveSettings
+{
+	double RelativeTolerance = 1e-10;
+
+	// in m, velocity tolerance is a thousandth of it in m / s
+	double PositionTolerance = 0.01;
+
+	// in s
+	double MinStep = 0.01;
+	double MaxStep = 900;
+};
+
+// Celestial bodies sampled on a fixed step ahead of simulation time.
+// Positions between samples are cubic Hermite interpolated.
+// Times are in seconds since Reset, Step is negative when time runs backwards.
+class ORBITSIM_API FSimCelestialTrack
+{
+public:
+	void Reset(const FSimStateStore& State, double Step);
+
+	void Append(const FSimStateStore& State);
+
+	// drop samples no longer needed to interpolate at Time
+	void Trim(double Time);
+
+	FORCEINLINE double GetStep() const
+	{
+		return Step;
+	}
+
+	FORCEINLINE double GetEndTime() const
+	{
+		return StartTime + Step * (NumSamples - 1);
+	}
+
+	// celestial bodies at Time and acceleration of the origin (index 0)
+	void Evaluate
+	(
+		double Time,
+		FSimAttractor* OutAttractors,
+		FVector& OutOriginAcceleration
+	) const;
+
+	void Evaluate
+	(
+		double Time,
+		int32 Index,
+		FVector& OutPosition,
+		FVector& OutVelocity
+	) const;
+
+	FORCEINLINE int32 GetNumCelestial() const
+	{
+		return NumCelestial;
+	}
+
+private:
+	int32 NumCelestial = 0;
+	int32 NumSamples = 0;
+
+	double Step = 0;
+	double StartTime = 0;
+
+	TArray<double> GM;
+	TArray<double> J2;
+	TArray<double> Radius;
+
+	// [sample * NumCelestial + body]
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+
+	// sample index and normalized time inside the interval
+	void Locate(double Time, int32& OutSample, double& OutFraction) const;
+};
+
+// Embedded Dormand-Prince 5(4) integration of physic bodies.
+// Every body keeps its own time and step length, bodies are ahead of
+// simulation time and reach it through dense output of their last step.
+class ORBITSIM_API FSimAdaptiveIntegrator
+{
+public:
+	FSimAdaptiveSettings Settings;
+
+public:
+	// start from State at time 0, negative SampleStep integrates backwards
+	void Reset(const FSimStateStore& State, double SampleStep);
+
+	// integrate celestial bodies far enough ahead of Time, StepCelestial
+	// advances a celestial only state at Time by the track step
+	void PrepareTrack
+	(
+		double Time,
+		TFunctionRef<void(FSimStateStore& CelestialState, double Time, double StepLength)> StepCelestial
+	);
+
+	// write celestial bodies of State at Time
+	void WriteCelestial(FSimStateStore& State, double Time) const;
+
+	// advance physic body at store index Index until Time and write it to State,
+	// bodies are independent and may be advanced from different threads
+	void AdvanceBody(FSimStateStore& State, int32 Index, double Time);
+
+	FORCEINLINE bool IsReady() const
+	{
+		return Bodies.Num() > 0 || Track.GetNumCelestial() > 0;
+	}
+
+	FORCEINLINE double GetDirection() const
+	{
+		return FMath::Sign(Track.GetStep());
+	}
+
+	// force evaluations of physic bodies since Reset
+	int64 GetNumEvaluations() const;
+
+private:
+	struct FBody
+	{
+		// state at Time, position (m) and velocity (m / s)
+		double Y[6];
+
+		// derivative at Time
+		double F[6];
+		bool HasDerivative = false;
+
+		double Time = 0;
+
+		// next step length, positive
+		double Step = 0;
+
+		// dense output over [Time - LastStep, Time]
+		double Dense[5][6];
+		double LastStep = 0;
+
+		int64 Evaluations = 0;
+	};
+
+	TArray<FBody> Bodies;
+
+	FSimCelestialTrack Track;
+
+	// time all bodies have reached
+	double LastTime = 0;
+
+	// celestial bodies at the end of the track
+	FSimStateStore CelestialState;
+
+	void Derivative(FBody& Body, double Time, const double* Y, double* OutF) const;
+
+	void Interpolate(const FBody& Body, double Time, double* OutY) const;
+};
@@ -0,0 +1,82 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimStateStore.h"
+
+// Two-body orbit around a central body with secular J2 drift of
+// the ascending node, the perigee and the mean anomaly.
+struct ORBITSIM_API FSimKeplerOrbit
+{
+	// store index of the central body, INDEX_NONE for the origin itself
+	int32 Central = INDEX_NONE;
+
+	// m^3 / s^2
+	double Mu = 0;
+
+	// in m
+	double SemiMajorAxis = 0;
+	double Eccentricity = 0;
+
+	// perigee and its 90 deg. ahead direction at epoch,
+	// perigee is replaced by the initial position on circular orbits
+	FVector P = FVector::Zero();
+	FVector Q = FVector::Zero();
+
+	// mean anomaly at epoch (rad)
+	double MeanAnomaly = 0;
+
+	// rad / s
+	double MeanMotion = 0;
+	double NodeRate = 0;
+	double PerigeeRate = 0;
+
+public:
+	// relative position (m) and velocity (m / s) to orbit elements,
+	// J2 and Radius (km) of the central body give secular rates
+	static bool FromState
+	(
+		const FVector& Position,
+		const FVector& Velocity,
+		double Mu,
+		double J2,
+		double Radius,
+		FSimKeplerOrbit& OutOrbit
+	);
+
+	// relative position and velocity Time seconds after epoch
+	void Evaluate(double Time, FVector& OutPosition, FVector& OutVelocity) const;
+};
+
+// Closed form propagation of bodies in a state store.
+// Each body orbits the celestial body that dominates its motion,
+// state at any time costs O(1) per body.
+class ORBITSIM_API FSimAnalyticPropagator
+{
+public:
+	// build orbits from State at time 0 for store indices [Begin, State.Num()),
+	// celestial bodies are included when Begin is 1,
+	// bodies on unbound orbits are not propagated
+	void Reset(const FSimStateStore& State, int32 Begin);
+
+	// write propagated bodies to State at Time seconds after Reset
+	void Evaluate(FSimStateStore& State, double Time) const;
+
+	FORCEINLINE int32 GetBegin() const
+	{
+		return Begin;
+	}
+
+private:
+	int32 Begin = 0;
+
+	// [index - Begin]
+	TArray<FSimKeplerOrbit> Orbits;
+	TArray<bool> Valid;
+
+	// celestial bodies after their central bodies
+	TArray<int32> CelestialOrder;
+
+	static int32 FindCentral(const FSimStateStore& State, int32 Index);
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SimEngine.h"
 #include "SimBody.generated.h"
 
 UCLASS()
@@ -21,21 +22,16 @@ public:
 	FString BodyName;
 
 	// in m
+	// mirrors FSimStateStore, integrated by ASimGameMode
 	FVector Position;
 
-	// position buffer
-	FVector P[4];
-
 	// in m / s
 	UPROPERTY(EditAnywhere, Category = "OrbitSim|Body")
 	FVector Velocity;
 
-	// velocity buffer
-	FVector V[4];
-
-	// acceleration buffer
-	// in m / s^2
-	FVector A[4];
+	// use ASimGameMode::SetBodyPropagation to change during simulation
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "OrbitSim|Body")
+	ESimPropagation Propagation = ESimPropagation::Numeric;
 
 	FVector PrevTrajectoryPoint;
 
@@ -51,7 +47,4 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
-
-public:
-	void ClearBuffers();
 };
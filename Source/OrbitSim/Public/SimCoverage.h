@@ -0,0 +1,187 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimFootprint.h"
+#include "SimCoverage.generated.h"
+
+UENUM(BlueprintType)
+enum class ESimCoverageGrid : uint8
+{
+	// cells of Resolution deg. of latitude and longitude
+	LatitudeLongitude,
+
+	// rings of Resolution deg. of latitude split into cells of about
+	// equal area, fewer cells toward the poles
+	EqualArea
+};
+
+// positions of satellites around the origin body at one time
+struct FSimCoverageSample
+{
+	FDateTime Time;
+
+	// log the sample was taken for
+	int32 Session = 0;
+
+	// in m
+	TArray<FVector> Positions;
+
+	// of the origin body (km)
+	double Radius = 0;
+
+	// of the origin body around its axis (deg.)
+	double Rotation = 0;
+};
+
+// Number of satellites seen above the 5 deg. elevation mask from cells of
+// a grid of rings of latitude on the origin body, with statistics of it
+// over samples. Rows of a sample are counted in parallel and only cells
+// inside the visibility cap of a satellite are tested, then every cell
+// of the row updates its statistics in the same pass.
+class ORBITSIM_API FSimCoverage
+{
+public:
+	// Resolution (deg.) is the height of a row and, on the equator, the width of a cell,
+	// the time with at least Folds[k] satellites is kept for every k
+	explicit FSimCoverage(ESimCoverageGrid iGrid = ESimCoverageGrid::LatitudeLongitude,
+	                      double Resolution = 1,
+	                      const TArray<int32>& iFolds = { 1 });
+
+	void Reset();
+
+	// add one sample of satellites at Positions (m) around a body
+	// of Radius (km) rotated by Rotation (deg.) around its axis at Time,
+	// samples come in order of time, visible satellites of every cell
+	// are also written to OutSample when given
+	void Accumulate(const FDateTime& Time, const TArray<FVector>& Positions, double Radius, double Rotation,
+	                float* OutSample = nullptr);
+
+	FORCEINLINE ESimCoverageGrid GetGrid() const
+	{
+		return Grid;
+	}
+
+	FORCEINLINE int32 GetNumSamples() const
+	{
+		return NumSamples;
+	}
+
+	FORCEINLINE int32 GetNumRows() const
+	{
+		return Rows.Num();
+	}
+
+	FORCEINLINE int32 GetNumCells() const
+	{
+		return Values.Num();
+	}
+
+	FORCEINLINE const TArray<int32>& GetFolds() const
+	{
+		return Folds;
+	}
+
+	// index of the first cell of a row and the number of its cells
+	FORCEINLINE int32 GetRowOffset(int32 Row) const
+	{
+		return Rows[Row].Offset;
+	}
+
+	FORCEINLINE int32 GetRowNum(int32 Row) const
+	{
+		return Rows[Row].Num;
+	}
+
+	// of cell centers (deg.)
+	double GetRowLatitude(int32 Row) const;
+	double GetCellLongitude(int32 Row, int32 Cell) const;
+
+	// per cell statistics, cells go row by row from the north pole
+	// and from 180 deg. west in a row
+
+	// visible satellites
+	TArray<double> GetAverage() const;
+	TArray<double> GetMinimum() const;
+	TArray<double> GetMaximum() const;
+
+	// of samples with at least Folds[Fold] visible satellites
+	TArray<double> GetFoldFraction(int32 Fold) const;
+
+	// longest time without satellites (s), including
+	// outages at the start and at the end of the log
+	TArray<double> GetLongestOutage() const;
+
+	// mean length of outages (s) counted the same way,
+	// 0 for cells that always see a satellite
+	TArray<double> GetMeanRevisit() const;
+
+	// CellValues of a statistic on a latitude / longitude raster
+	// of twice as many columns as rows, row by row from the north pole
+	TArray<double> Render(const TArray<double>& CellValues, int32& OutWidth, int32& OutHeight) const;
+
+private:
+	ESimCoverageGrid Grid;
+
+	struct FRow
+	{
+		// index of the first cell
+		int32 Offset;
+		int32 Num;
+
+		// of the latitude
+		double Sin;
+		double Cos;
+
+		// longitude span of a cell (deg.)
+		double Width;
+
+		// of the longitude span of a cell
+		double StepSin;
+		double StepCos;
+	};
+
+	TArray<FRow> Rows;
+
+	TArray<int32> Folds;
+
+	// visible satellites in the sample being accumulated
+	TArray<uint16> Current;
+
+	// sum of visible satellites over samples
+	TArray<double> Values;
+
+	TArray<uint16> Minimum;
+	TArray<uint16> Maximum;
+
+	// [cell * Folds.Num() + fold] samples with at least Folds[fold] satellites
+	TArray<int32> FoldSamples;
+
+	// time (s since FirstTime) of the first sample of the running outage, -1 while seen
+	TArray<double> OutageStart;
+
+	// of outages that ended
+	TArray<double> LongestOutage;
+
+	TArray<double> OutageSum;
+	TArray<int32> NumOutages;
+
+	int32 NumSamples = 0;
+	FDateTime FirstTime;
+
+	// s since FirstTime
+	double LastTime = 0;
+
+	struct FSatellite
+	{
+		FSimFootprint Footprint;
+
+		// rows the cap may touch
+		int32 FirstRow;
+		int32 LastRow;
+	};
+
+	// satellites of the sample being accumulated
+	TArray<FSatellite> Satellites;
+};
@@ -0,0 +1,116 @@
+// DHmelevcev 2025
+
+#pragma once
+
+class FSimCoverage;
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+#include "CoreMinimal.h"
+
+// Coverage samples over time in a binary file, little endian:
+//   header   FSimCoverageCubeHeader
+//   rows     NumRows pairs of int32 (first cell, number of cells)
+//   samples  from DataOffset, RecordSize bytes each:
+//            int64 FDateTime ticks, NumCells float32 visible satellites
+// Records have a fixed size, so any sample is found without reading others.
+struct FSimCoverageCubeHeader
+{
+	static constexpr uint32 FileMagic = 0x4255434F; // "OCUB"
+	static constexpr uint32 FileVersion = 1;
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+
+	// ESimCoverageGrid
+	int32 Grid = 0;
+	int32 NumRows = 0;
+	int32 NumCells = 0;
+	int32 Reserved = 0;
+
+	// written when the file is closed, readers of an unfinished
+	// file count whole records instead
+	int64 NumSamples = 0;
+
+	// of the first sample and of one sample, multiples of 8
+	int64 DataOffset = 0;
+	int64 RecordSize = 0;
+};
+
+// Appends samples of one coverage grid to a cube file,
+// samples are collected into chunks of a few MB per write.
+class ORBITSIM_API FSimCoverageCubeWriter
+{
+public:
+	~FSimCoverageCubeWriter();
+
+	// create File for samples of Coverage grid
+	bool Open(const FString& File, const FSimCoverage& Coverage);
+
+	FORCEINLINE bool IsOpen() const
+	{
+		return Handle.IsValid();
+	}
+
+	// NumCells values to fill for a sample at Time,
+	// valid until the next AddSample or Close
+	float* AddSample(const FDateTime& Time);
+
+	// write buffered samples and the sample count
+	bool Close();
+
+private:
+	TUniquePtr<IFileHandle> Handle;
+
+	FSimCoverageCubeHeader Header;
+
+	// whole records of the chunk being collected
+	TArray<uint8> Chunk;
+	int32 ChunkSamples = 0;
+	int32 NumBuffered = 0;
+
+	// a write failed, the file is incomplete
+	bool Failed = false;
+
+	bool Flush();
+};
+
+// Reads samples of a cube file in place through a memory mapping,
+// only pages of samples that are accessed are loaded.
+class ORBITSIM_API FSimCoverageCubeReader
+{
+public:
+	~FSimCoverageCubeReader();
+
+	bool Open(const FString& File);
+
+	void Close();
+
+	FORCEINLINE const FSimCoverageCubeHeader& GetHeader() const
+	{
+		return Header;
+	}
+
+	FORCEINLINE int64 GetNumSamples() const
+	{
+		return NumSamples;
+	}
+
+	// first cell and number of cells of a row, rows go from the north pole
+	void GetRow(int32 Row, int32& OutOffset, int32& OutNum) const;
+
+	FDateTime GetTime(int64 Sample) const;
+
+	// visible satellites of every cell at a sample
+	TArrayView<const float> GetSample(int64 Sample) const;
+
+private:
+	TUniquePtr<IMappedFileHandle> Handle;
+	TUniquePtr<IMappedFileRegion> Region;
+
+	FSimCoverageCubeHeader Header;
+	int64 NumSamples = 0;
+
+	const uint8* Data = nullptr;
+};
@@ -0,0 +1,42 @@
+// DHmelevcev 2025
+
+#pragma once
+
+class FSimEngine;
+
+#include "CoreMinimal.h"
+
+// Positions of physic bodies of an engine at any time of its last step
+// by cubic Hermite interpolation between positions and velocities at both
+// ends of the step, so samples are taken at exact epochs whatever the step.
+// The error is below h^4 / 384 of the fourth derivative of the orbit.
+// Only coverage samples are taken through it: links are gathered from
+// actors at frame time, interpolated between snapshots to WorldTime, and
+// exported states and ephemerides are those at step ends.
+class ORBITSIM_API FSimDenseOutput
+{
+public:
+	// before FSimEngine::Step or Skip
+	void BeginStep(const FSimEngine& Engine);
+
+	// after it
+	void EndStep(const FSimEngine& Engine);
+
+	// the last step ended at the current engine state and reaches Time,
+	// the engine time itself is always covered
+	bool Covers(const FSimEngine& Engine, const FDateTime& Time) const;
+
+	// positions (m) of physic bodies at Time, false and
+	// nothing written when Time is not covered
+	bool GetPositions(const FSimEngine& Engine, const FDateTime& Time, TArray<FVector>& OutPositions) const;
+
+private:
+	FDateTime Start;
+	FDateTime End;
+
+	bool Valid = false;
+
+	// of physic bodies at Start
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+};
@@ -0,0 +1,289 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimStateStore.h"
+#include "SimAdaptiveIntegrator.h"
+#include "SimMultistepIntegrator.h"
+#include "SimAnalyticPropagator.h"
+#include "SimEphemeris.h"
+#include "SimEngine.generated.h"
+
+// Standard gravitational parameter (m^3 / s^2)
+constexpr double GM_Earth = 398600441800000.;
+constexpr double GM_Moon = 4904869500000.;
+constexpr double GM_Sun = 132712440042000000000.;
+
+// J2 Perturbation
+constexpr double J2_Earth = 0.00108262668;
+constexpr double J2_Moon = 0.0002027;
+constexpr double J2_Sun = 0.00000022;
+
+// Radius (km)
+constexpr double R_Earth = 6371.;
+constexpr double R_Moon = 1737.4;
+constexpr double R_Sun = 696340.;
+
+// Sidereal rotation period (s)
+constexpr double SRP_Earth = 86164.0905;
+constexpr double SRP_Moon = 2360591.5104;
+constexpr double SRP_Sun = 2114208.0;
+
+// Geostationary Earth orbit
+constexpr double GEO_SMA = 42164;
+constexpr double GEO_E = 0;
+constexpr double GEO_I = 0;
+
+// Sun-synchronous orbit
+constexpr double SSO_SMA = 7272;
+constexpr double SSO_E = 0;
+constexpr double SSO_I = 99;
+
+// Molniya orbit
+constexpr double MOLNIYA_SMA = 26600;
+constexpr double MOLNIYA_E = 0.74;
+constexpr double MOLNIYA_I = 63.4;
+constexpr double MOLNIYA_AP = 270;
+
+// Tundra orbit
+constexpr double TUNDRA_SMA = 42164;
+constexpr double TUNDRA_E = 0.25;
+constexpr double TUNDRA_I = 63.4;
+constexpr double TUNDRA_AP = 270;
+
+UENUM(BlueprintType)
+enum class ESimIntegrator : uint8
+{
+	// classic Runge-Kutta with fixed dt
+	RK4,
+
+	// embedded Runge-Kutta 5(4) with step length per body
+	DormandPrince,
+
+	// Adams-Bashforth-Moulton 8 with fixed dt, reuses past accelerations
+	AdamsBashforthMoulton
+};
+
+UENUM(BlueprintType)
+enum class ESimPropagation : uint8
+{
+	// integrated with all forces
+	Numeric,
+
+	// closed form Kepler orbit with secular J2 drift
+	Analytic
+};
+
+// options of FSimEngine, ASimGameMode exposes them as properties
+struct FSimEngineSettings
+{
+	ESimIntegrator Integrator = ESimIntegrator::RK4;
+
+	// Analytic propagates every body in closed form
+	ESimPropagation Propagation = ESimPropagation::Numeric;
+
+	// DormandPrince error control
+	double RelativeTolerance = 1e-12;
+
+	// DormandPrince error control (m)
+	double PositionTolerance = 1e-5;
+
+	// longest DormandPrince step (s)
+	double MaxStep = 900;
+
+	// AdamsBashforthMoulton evaluates forces again after the corrector
+	bool CorrectorEvaluation = true;
+
+	// celestial bodies follow Ephemeris where it covers simulation time
+	bool CelestialEphemeris = true;
+
+	// longest step (s) of the integration an ephemeris is fitted to
+	double EphemerisStep = 60;
+
+	// split physic bodies between worker threads during integration
+	bool ParallelIntegration = true;
+	int32 ParallelChunkSize = 64;
+
+	// use AVX2 / AVX-512 acceleration kernel when CPU supports it
+	bool VectorizedIntegration = true;
+};
+
+// Force model and integrators of a state store, independent of actors.
+// ASimGameMode drives it from the physics thread and mirrors State to
+// actors, UOrbitSimBatchCommandlet runs it headless at full speed.
+// Methods are not thread safe, one thread advances the engine at a time.
+class ORBITSIM_API FSimEngine
+{
+public:
+	inline static const FTimespan dt = ETimespan::TicksPerSecond * 5;
+	inline static const double dtSeconds = dt.GetTotalSeconds();
+
+	FSimEngineSettings Settings;
+
+	// time of State
+	FDateTime UpdatedTo = FDateTime::FromUnixTimestamp(0);
+
+	// integrated state of all bodies
+	FSimStateStore State;
+
+	FSimEphemeris Ephemeris;
+
+public:
+	// State or Ephemeris was replaced, drop integrator history,
+	// celestial bodies are matched to the ephemeris by CelestialNames
+	void Reset(const TArray<FString>& CelestialNames);
+
+	// a dt step in Direction does not pass Target
+	bool IsAhead(const FDateTime& Target, int32 Direction) const;
+
+	// with Analytic propagation skip to the last dt step short of Target
+	// in Direction at once,
+	// returns the number of dt steps skipped, 0 when bodies are integrated
+	int64 Skip(const FDateTime& Target, int32 Direction);
+
+	// one dt step of State in Direction
+	void Step(int32 Direction);
+
+	// fit Ephemeris to celestial bodies of Celestial integrated over
+	// [UpdatedTo + Begin, UpdatedTo + End], times in s
+	void BuildEphemeris
+	(
+		const FSimStateStore& Celestial,
+		const TArray<FString>& CelestialNames,
+		double Begin,
+		double End
+	);
+
+	// positions of physic bodies of State
+	void GetPhysicPositions(TArray<FVector>& OutPositions) const;
+
+	// rotation (deg.) of a celestial body around its axis at UpdatedTo
+	FORCEINLINE double GetRotation(int32 Index) const
+	{
+		return GetRotation(Index, UpdatedTo);
+	}
+
+	// the same at any Time
+	double GetRotation(int32 Index, const FDateTime& Time) const;
+
+	// position (m) and velocity (m / s) relative to a body of GM (m^3 / s^2)
+	// on an orbit of SemiMajorAxis (km), angles in deg.
+	static void OrbitToState
+	(
+		double GM,
+		double SemiMajorAxis,
+		double Eccentricity,
+		double Inclination,
+		double LongitudeOfAscendingNode,
+		double ArgumentOfPerigee,
+		double TrueAnomaly,
+		FVector& OutPosition,
+		FVector& OutVelocity
+	);
+
+private:
+	FSimAdaptiveIntegrator AdaptiveIntegrator;
+
+	// adaptive integrator was reset from State at UpdatedTo - AdaptiveTime
+	bool AdaptiveReady = false;
+	double AdaptiveTime = 0;
+
+	// ephemeris time of the adaptive integrator reset
+	double AdaptiveEpoch = 0;
+
+	FSimMultistepIntegrator MultistepIntegrator;
+
+	// multistep history was started with steps of MultistepStep
+	bool MultistepReady = false;
+	double MultistepStep = 0;
+
+	// celestial bodies of the multistep history came from the ephemeris
+	bool MultistepEphemeris = false;
+
+	// all celestial bodies are in Ephemeris
+	bool EphemerisReady = false;
+
+	// [celestial store index] ephemeris body
+	TArray<int32> EphemerisBodies;
+
+	FSimAnalyticPropagator AnalyticPropagator;
+
+	// analytic orbits were built from State at AnalyticEpoch
+	bool AnalyticReady = false;
+	FDateTime AnalyticEpoch;
+
+private:
+	void CalculateCelestialAccelerations
+	(
+		FSimStateStore& Store,
+		int32 Stage
+	);
+
+	void CalculatePhysicAccelerations
+	(
+		FSimStateStore& Store,
+		int32 Stage,
+		int32 Begin,
+		int32 End
+	);
+
+	void IntegrationStage
+	(
+		FSimStateStore& Store,
+		int32 Index,
+		double StepLength,
+		int32 Stage
+	);
+
+	void IntegrationStep
+	(
+		FSimStateStore& Store,
+		int32 Index,
+		double StepLength
+	);
+
+	// zero Store.A[Stage] and fill it with accelerations
+	// of bodies at Store.P[Stage] relative to the origin,
+	// with bOnEphemeris celestial bodies only pull
+	void CalculateAccelerations
+	(
+		FSimStateStore& Store,
+		int32 Stage,
+		bool bOnEphemeris = false
+	);
+
+	// seconds since the ephemeris epoch
+	FORCEINLINE double GetEphemerisTime(const FDateTime& Time) const
+	{
+		return (Time - Ephemeris.GetEpoch()).GetTotalSeconds();
+	}
+
+	// celestial bodies are looked up over [Time, Time + DeltaTime]
+	bool IsOnEphemeris(double Time, double DeltaTime) const;
+
+	// celestial positions at Time to Store.P[Stage]
+	void LoadCelestialStage(FSimStateStore& Store, int32 Stage, double Time) const;
+
+	// celestial positions and velocities at Time to Store
+	void LoadCelestialState(FSimStateStore& Store, double Time) const;
+
+	// point mass attraction of celestial bodies at Store.P[Stage] on the origin
+	static FVector OriginAcceleration(const FSimStateStore& Store, int32 Stage);
+
+	// run Function over ranges of physic body indices in Store
+	void ForEachPhysicChunk
+	(
+		const FSimStateStore& Store,
+		TFunctionRef<void(int32 Begin, int32 End)> Function
+	) const;
+
+	// RK4 step of all bodies in Store from ephemeris time Time
+	void Integrate(FSimStateStore& Store, double DeltaTime, double Time);
+
+	// DormandPrince step of State
+	void IntegrateAdaptive(double DeltaTime, double Time);
+
+	// AdamsBashforthMoulton step of State
+	void IntegrateMultistep(double DeltaTime, double Time);
+};
@@ -0,0 +1,71 @@
+// DHmelevcev 2025
+
+#pragma once
+
+class FJsonObject;
+
+#include "CoreMinimal.h"
+#include "SimStateStore.h"
+
+// Positions of celestial bodies as Chebyshev series on segments of equal
+// length, relative to the body that was the origin when it was fitted.
+// Times are in seconds since Epoch, lookup at any covered time is O(1).
+class ORBITSIM_API FSimEphemeris
+{
+public:
+	static constexpr double DefaultSegmentLength = 4 * 86400.;
+	static constexpr int32 DefaultNumCoefficients = 14;
+
+	// integrate celestial bodies of State from Epoch over [Begin, End]
+	// with steps of at most MaxStep and fit segments to the result,
+	// StepCelestial advances a celestial only state by StepLength
+	void Fit
+	(
+		const FSimStateStore& State,
+		const TArray<FString>& iNames,
+		const FDateTime& iEpoch,
+		double Begin,
+		double End,
+		double MaxStep,
+		TFunctionRef<void(FSimStateStore& CelestialState, double StepLength)> StepCelestial,
+		double iSegmentLength = DefaultSegmentLength,
+		int32 iNumCoefficients = DefaultNumCoefficients
+	);
+
+	TSharedRef<FJsonObject> ToJson() const;
+
+	bool FromJson(const FJsonObject& Json);
+
+	FORCEINLINE int32 Num() const
+	{
+		return Names.Num();
+	}
+
+	FORCEINLINE const FDateTime& GetEpoch() const
+	{
+		return Epoch;
+	}
+
+	// body index by name, INDEX_NONE if it is not in the ephemeris
+	FORCEINLINE int32 Find(const FString& Name) const
+	{
+		return Names.Find(Name);
+	}
+
+	bool Covers(double Time) const;
+
+	// position (m) and velocity (m / s) of Body at Time
+	void Evaluate(int32 Body, double Time, FVector& OutPosition, FVector& OutVelocity) const;
+
+private:
+	TArray<FString> Names;
+	FDateTime Epoch;
+
+	double StartTime = 0;
+	double SegmentLength = DefaultSegmentLength;
+	int32 NumSegments = 0;
+	int32 NumCoefficients = 0;
+
+	// [((body * NumSegments + segment) * 3 + axis) * NumCoefficients + j]
+	TArray<double> Coefficients;
+};
@@ -4,11 +4,84 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Misc/Optional.h"
+#include "SimEngine.h"
 #include "SimFileManager.generated.h"
 
 class ASimGameMode;
 class FJsonObject;
+class FSimCoverage;
+class FSimEphemeris;
 class UListView;
+struct FSimAccessWindow;
+
+// satellite of a scenario file
+struct FSimScenarioSatellite
+{
+	FString Name;
+
+	// celestial body it orbits
+	FString Body;
+
+	// in km
+	double SemiMajorAxis = 0;
+	double Eccentricity = 0;
+
+	// in deg.
+	double Inclination = 0;
+	double LongitudeOfAscendingNode = 0;
+	double ArgumentOfPerigee = 0;
+	double TrueAnomaly = 0;
+
+	TOptional<ESimPropagation> Propagation;
+};
+
+// ground station of a scenario file
+struct FSimScenarioStation
+{
+	FString Name;
+
+	// celestial body it stands on
+	FString Body;
+
+	// in deg.
+	double Latitude = 0;
+	double Longitude = 0;
+};
+
+// celestial body of a scenario file, used where there is no level
+struct FSimScenarioBody
+{
+	FString Name;
+
+	// m^3 / s^2
+	double GM = 0;
+	double J2 = 0;
+
+	// in km
+	double Radius = 0;
+
+	// in s
+	double SiderealRotationPeriod = 0;
+
+	// in m and m / s, relative to the first body
+	FVector Position = FVector::Zero();
+	FVector Velocity = FVector::Zero();
+};
+
+// contents of a scenario file other than engine settings
+struct FSimScenario
+{
+	// absolute path, empty without ephemeris
+	FString Ephemeris;
+
+	// the first one is the origin
+	TArray<FSimScenarioBody> CelestialBodies;
+
+	TArray<FSimScenarioSatellite> Satellites;
+
+	TArray<FSimScenarioStation> Stations;
+};
 
 UCLASS()
 class ORBITSIM_API USimFileManager : public UBlueprintFunctionLibrary
@@ -31,5 +104,23 @@ public:
 public:
 	static TSharedPtr<FJsonObject> ReadJsonFromString(const FString& JsonString);
 
-	static void SaveCoverageData(const TArray<double>& iData);
+	// settings present in the scenario File overwrite InOutSettings
+	static bool ReadScenario(const FString& File, FSimScenario& OutScenario, FSimEngineSettings& InOutSettings);
+
+	// bitmap of iData of iWidth x iHeight values row by row from the north
+	static bool SaveCoverageData(const TArray<double>& iData, int32 iWidth, int32 iHeight, const FString& File);
+
+	// statistics of every cell as comma separated values
+	static bool SaveCoverageStatistics(const FSimCoverage& Coverage, const FString& File);
+
+	// one line per window with times from Start as ISO 8601
+	static bool SaveAccessWindows(const TArray<FSimAccessWindow>& Windows,
+	                              const FDateTime& Start,
+	                              const TArray<FString>& StationNames,
+	                              const TArray<FString>& SatelliteNames,
+	                              const FString& File);
+
+	static bool SaveEphemeris(const FSimEphemeris& Ephemeris, const FString& File);
+
+	static bool LoadEphemeris(FSimEphemeris& Ephemeris, const FString& File);
 };
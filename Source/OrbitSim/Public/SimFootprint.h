@@ -0,0 +1,72 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// sin(5 deg.), the lowest elevation a satellite is seen at from the ground
+// by links, coverage and ground terminals
+constexpr double SinElevationMask = 0.087155742;
+
+// Cap of a body surface that sees a satellite above the elevation mask.
+// Surfaces are split into rows of latitude from the north pole and rows
+// into cells of longitude, cell i of a row spans (i, i + 1) widths from
+// 180 deg. west, as the coverage grid and ground terminals are. Ranges of
+// rows and cells the cap may touch are found in closed form, points in
+// them are tested exactly.
+struct ORBITSIM_API FSimFootprint
+{
+	// in body-fixed coordinates (m)
+	FVector Position;
+
+	// in m
+	double Radius;
+
+	// |Position|^2 + Radius^2 (m^2)
+	double Distance2;
+
+	// of the subsatellite point
+	double SinLatitude;
+	double CosLatitude;
+
+	// central angle the cap spans (deg.) and its cos
+	double CapDegrees;
+	double CosCap;
+
+	// longitude of the subsatellite point plus 180 deg., from 0 to 540
+	double Column;
+
+	// satellite at Position (m) relative to a body of Radius (km)
+	// in body-fixed coordinates, false when it is not above the surface
+	bool Set(const FVector& iPosition, double iRadius);
+
+	// rows of Height (deg.) the cap may touch, clamped to [0, NumRows)
+	void GetRows(double Height, int32 NumRows, int32& OutFirst, int32& OutLast) const;
+
+	// latitude (deg.) between Bottom and Top the cap spans most cells at
+	double GetWidestLatitude(double Bottom, double Top) const;
+
+	// cells of Width (deg.) of a row of Num at the latitude of sin and cos
+	// the cap may touch, Last may pass Num - 1 and First may be negative,
+	// cell indices wrap, false when it touches none
+	bool GetColumns
+	(
+		double SinRow,
+		double CosRow,
+		double Width,
+		int32 Num,
+		int32& OutFirst,
+		int32& OutLast
+	) const;
+
+	// a surface point with body-fixed Up direction sees the satellite above the mask
+	FORCEINLINE bool IsVisible(const FVector& Up) const
+	{
+		// (p - o) . u >= sin(5 deg.) |p - o| with o = R u,
+		// squared to avoid the square root
+		const double pu = FVector::DotProduct(Position, Up);
+		const double h = pu - Radius;
+
+		return h > 0 && h * h >= SinElevationMask * SinElevationMask * (Distance2 - 2 * Radius * pu);
+	}
+};
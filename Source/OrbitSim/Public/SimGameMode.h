@@ -10,71 +10,164 @@ class ASimBaseStation;
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "SimEngine.h"
+#include "SimCoverage.h"
+#include "SimDenseOutput.h"
+#include "SimPhysicsThread.h"
+#include "SimSpscRing.h"
+#include "SimBody.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
 #include "SimGameMode.generated.h"
 
-// Standard gravitational parameter (m^3 / s^2)
-constexpr double GM_Earth = 398600441800000.;
-constexpr double GM_Moon = 4904869500000.;
-constexpr double GM_Sun = 132712440042000000000.;
-
-// J2 Perturbation
-constexpr double J2_Earth = 0.00108262668;
-constexpr double J2_Moon = 0.0002027;
-constexpr double J2_Sun = 0.00000022;
-
-// Radius (km)
-constexpr double R_Earth = 6371.;
-constexpr double R_Moon = 1737.4;
-constexpr double R_Sun = 696340.;
-
-// Sidereal rotation period (s)
-constexpr double SRP_Earth = 86164.0905;
-constexpr double SRP_Moon = 2360591.5104;
-constexpr double SRP_Sun = 2114208.0;
-
-// Geostationary Earth orbit
-constexpr double GEO_SMA = 42164;
-constexpr double GEO_E = 0;
-constexpr double GEO_I = 0;
-
-// Sun-synchronous orbit
-constexpr double SSO_SMA = 7272;
-constexpr double SSO_E = 0;
-constexpr double SSO_I = 99;
-
-// Molniya orbit
-constexpr double MOLNIYA_SMA = 26600;
-constexpr double MOLNIYA_E = 0.74;
-constexpr double MOLNIYA_I = 63.4;
-constexpr double MOLNIYA_AP = 270;
-
-// Tundra orbit
-constexpr double TUNDRA_SMA = 42164;
-constexpr double TUNDRA_E = 0.25;
-constexpr double TUNDRA_I = 63.4;
-constexpr double TUNDRA_AP = 270;
+UENUM(BlueprintType)
+enum class ESimLogBackpressure : uint8
+{
+	// coverage samples are lost while the log is behind
+	Drop,
+
+	// integration waits while the log is behind
+	Throttle
+};
+
+// properties the physics thread steps and samples the log with,
+// copied on the game thread
+struct FSimStepSettings
+{
+	FSimEngineSettings Engine;
+
+	double LogSampleInterval = 30;
+	ESimLogBackpressure LogBackpressure = ESimLogBackpressure::Throttle;
+};
 
 UCLASS()
 class ORBITSIM_API ASimGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
+
+	friend class FSimPhysicsThread;
 	
 public:
 	ASimGameMode();
 
-	FDateTime UpdatedTo;
-
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "OrbitSim|Time")
 	FDateTime WorldTime;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "OrbitSim|Time")
 	int32 TimeDilation;
 
-	inline static const FTimespan dt = ETimespan::TicksPerSecond * 5;
-	inline static const double dtSeconds = dt.GetTotalSeconds();
+	// simulation time (s) shown bodies are behind WorldTime
+	// because physics can not keep up
+	UPROPERTY(BlueprintReadOnly, Category = "OrbitSim|Time")
+	double SimLag = 0;
+
+	// JumpToTime is in progress
+	UPROPERTY(BlueprintReadOnly, Category = "OrbitSim|Time")
+	bool Jumping = false;
+
+	// part of the current jump done, from 0 to 1
+	UPROPERTY(BlueprintReadOnly, Category = "OrbitSim|Time")
+	float JumpProgress = 0;
+
+	inline static const FTimespan dt = FSimEngine::dt;
+	inline static const double dtSeconds = FSimEngine::dtSeconds;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration")
+	ESimIntegrator Integrator = ESimIntegrator::RK4;
+
+	// Analytic propagates every body in closed form, time jumps are instant,
+	// use SetPropagation to change during simulation
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "OrbitSim|Integration")
+	ESimPropagation Propagation = ESimPropagation::Numeric;
+
+	// DormandPrince error control
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration")
+	double RelativeTolerance = 1e-12;
+
+	// DormandPrince error control (m)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration")
+	double PositionTolerance = 1e-5;
+
+	// longest DormandPrince step (s)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration", meta = (ClampMin = "5"))
+	double MaxStep = 900;
+
+	// celestial bodies follow the built or loaded ephemeris where it covers
+	// simulation time instead of being integrated
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Ephemeris")
+	bool CelestialEphemeris = true;
+
+	// longest step (s) of the integration an ephemeris is fitted to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Ephemeris", meta = (ClampMin = "1"))
+	double EphemerisStep = 60;
+
+	// AdamsBashforthMoulton evaluates forces again after the corrector,
+	// otherwise predicted ones are reused, one evaluation per step
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration")
+	bool CorrectorEvaluation = true;
+
+	// split physic bodies between worker threads during integration
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration")
+	bool ParallelIntegration = true;
+
+	// physic bodies integrated by one worker task
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration", meta = (ClampMin = "1"))
+	int32 ParallelChunkSize = 64;
+
+	// use AVX2 / AVX-512 acceleration kernel when CPU supports it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration")
+	bool VectorizedIntegration = true;
+
+	// integrate on a dedicated thread ahead of render time,
+	// otherwise the game thread catches up every frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "OrbitSim|Integration")
+	bool SimulationThread = true;
+
+	// real time (s) the physics thread runs ahead of WorldTime
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration", meta = (ClampMin = "0"))
+	double SimulationLead = 0.1;
+
+	// longest snapshot interval (s) bodies are interpolated over,
+	// on longer ones they jump between snapshots
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration", meta = (ClampMin = "0"))
+	double MaxInterpolationInterval = 600;
+
+	// time (ms) a frame may spend integrating without SimulationThread
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Integration", meta = (ClampMin = "0"))
+	double PhysicsBudget = 8;
+
+	// what integration does when the coverage log falls behind
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Log")
+	ESimLogBackpressure LogBackpressure = ESimLogBackpressure::Throttle;
+
+	// simulation time (s) between coverage samples, taken at exact
+	// epochs from the log start by interpolating integration steps
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Log", meta = (ClampMin = "0.001"))
+	double LogSampleInterval = 30;
+
+	// coverage samples integration may be ahead of the log
+	UPROPERTY(EditDefaultsOnly, Category = "OrbitSim|Log", meta = (ClampMin = "2"))
+	int32 LogBufferSize = 64;
+
+	// tiling of the coverage log, EqualArea drops most polar cells
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Log")
+	ESimCoverageGrid CoverageGrid = ESimCoverageGrid::LatitudeLongitude;
+
+	// row height and equatorial cell width (deg.) of the coverage log,
+	// memory and time grow with the inverse square
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Log", meta = (ClampMin = "0.01", ClampMax = "180"))
+	double CoverageResolution = 1;
+
+	// the coverage log keeps the time cells see at least this many satellites
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Log")
+	TArray<int32> CoverageFolds = { 1, 2, 4 };
+
+	// the coverage log also writes every sample to Saved/log.cube
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Log")
+	bool CoverageCube = false;
 
 public:
-	bool LogEnabled = false;
+	std::atomic<bool> LogEnabled{ false };
 
 public:
 	TArray<ASimBody*> PhysicBodies; // all bodies except celestial bodies
@@ -82,6 +175,49 @@ public:
 
 	TArray<ASimBaseStation*> BaseStations;
 
+	// integrated state and its time, actors only mirror it,
+	// owned by the physics thread while it runs
+	FSimEngine Engine;
+
+private:
+	// bodies were added, removed or moved outside of integration
+	bool StateDirty = true;
+
+	TUniquePtr<FSimPhysicsThread> PhysicsThread;
+
+	// direction of time the physics thread integrates in
+	int32 SimDirection = 0;
+
+	// posted by the game thread every frame, taken by the physics
+	// thread before its next step
+	FCriticalSection StepSettingsLock;
+	FSimStepSettings PostedStepSettings;
+	std::atomic<bool> StepSettingsPosted{ false };
+
+	// physics thread, or game thread while paused
+	FSimStepSettings StepSettings;
+
+	// produced by the physics thread, consumed by the log task
+	TSharedPtr<TSimSpscRing<FSimCoverageSample>, ESPMode::ThreadSafe> LogSamples;
+
+	// incremented by every StartLog
+	std::atomic<int32> LogSession{ 0 };
+
+	// samples lost with Drop backpressure in the current log
+	std::atomic<int32> LogDropped{ 0 };
+
+	// physics thread, session, direction and epoch of the next sample
+	int32 LogSampledSession = 0;
+	int32 LogSampledDirection = 0;
+	FDateTime LogNextSample;
+
+	// physics thread, positions within the last step for samples
+	FSimDenseOutput LogDense;
+
+	FDateTime JumpStart;
+	FDateTime JumpTarget;
+	int32 JumpDirection = 0;
+
 private:
 	ASimTrajectoriesHandler* TrajectoriesHandler = nullptr;
 	ASimSignalHandler* SignalHandler = nullptr;
@@ -92,6 +228,8 @@ private:
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	virtual void Tick(float DeltaTime) override;
 
@@ -111,9 +249,46 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Trajectory")
 	void SetOrigin(ASimCelestialBody* NewOrigin);
 
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Integration")
+	void SetPropagation(ESimPropagation NewPropagation);
+
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Integration")
+	void SetBodyPropagation(ASimBody* Body, ESimPropagation NewPropagation);
+
 	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Log")
 	void StartLog();
 
+	// engine options from properties
+	FSimEngineSettings GetEngineSettings() const;
+
+	// properties from engine options
+	void SetEngineSettings(const FSimEngineSettings& Settings);
+
+	// integrate celestial bodies DaysBefore and DaysAfter the current time
+	// once and fit an ephemeris to them
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Ephemeris")
+	bool BuildEphemeris(double DaysBefore = 0, double DaysAfter = 365);
+
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Ephemeris")
+	bool SaveEphemeris(const FString& File) const;
+
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Ephemeris")
+	bool LoadEphemeris(const FString& File);
+
+	// plan passes of every physic body over every base station Days
+	// ahead of the shown time and write them to File
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Access")
+	bool SaveAccessWindows(double Days, const FString& File) const;
+
+	// move WorldTime to Time as fast as physics goes without blocking
+	// frames, bodies are shown as they are integrated
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Time")
+	void JumpToTime(FDateTime Time);
+
+	// stop the jump at the time reached so far
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Time")
+	void CancelJump();
+
 private:
 	bool SetBodyOrbit
 	(
@@ -128,22 +303,37 @@ private:
 		double TrueAnomaly
 	);
 
-	void UpdateTrajectoryLines();
+	// move analytic physic bodies to the end, returns their number
+	int32 PartitionPhysicBodies();
 
-	void CalculateAccelerations(int32 Stage) const;
+	// stop the physics thread and rewind State and actors to the shown
+	// snapshot, so bodies can be changed on the game thread
+	void PauseSimulation();
 
-	void IntegrationStage
-	(
-		ASimBody& Body,
-		double StepLength,
-		int32 Stage
-	) const;
+	// gather State from actors and restart the physics thread
+	void ResetSimulation();
 
-	void IntegrationStep
-	(
-		ASimBody& Body,
-		double StepLength
-	) const;
+	// copy properties for the physics thread, game thread
+	void PostStepSettings();
+
+	// latest posted properties to StepSettings and Engine, physics thread
+	// or game thread while paused
+	void TakeStepSettings();
+
+	// advance through published snapshots up to WorldTime and
+	// interpolate actor positions and velocities between them
+	void ApplySnapshots();
+
+	// progress and end of JumpToTime
+	void UpdateJump();
+
+	// one step of State toward Target in Direction, physics thread,
+	// returns the number of dt steps taken
+	int32 StepSimulation(const FDateTime& Target, int32 Direction);
+
+	// write coverage samples due up to the engine time, physics thread,
+	// false when the log is full and integration has to wait
+	bool WriteLogSamples(int32 Direction);
 
-	void Integrate(double DeltaTime);
+	void UpdateTrajectoryLines(const FSimSnapshot& Snapshot);
 };
@@ -0,0 +1,94 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Ground points of one celestial body, many more than stations can be,
+// bucketed into cells of about equal area: rows of latitude split into
+// cells of longitude, as the EqualArea coverage grid. The footprint of a
+// satellite above the 5 deg. elevation mask covers a range of rows and
+// of cells in each, only terminals of those cells are tested, so a query
+// costs about the number of visible terminals.
+class ORBITSIM_API FSimGroundTerminals
+{
+public:
+	// row height and equatorial cell width (deg.)
+	explicit FSimGroundTerminals(double Resolution = 1);
+
+	// in deg., returns the index of the terminal
+	int32 Add(double Latitude, double Longitude);
+
+	void Reset();
+
+	FORCEINLINE int32 Num() const
+	{
+		return Latitudes.Num();
+	}
+
+	FORCEINLINE double GetLatitude(int32 Terminal) const
+	{
+		return Latitudes[Terminal];
+	}
+
+	FORCEINLINE double GetLongitude(int32 Terminal) const
+	{
+		return Longitudes[Terminal];
+	}
+
+	// terminals seen by each of Positions (m, relative to the body centre)
+	// on a body of Radius (km) turned by Rotation (deg.),
+	// those of satellite i are OutTerminals[OutFirst[i]] to OutTerminals[OutFirst[i + 1] - 1]
+	void FindVisible
+	(
+		const TArray<FVector>& Positions,
+		double Radius,
+		double Rotation,
+		TArray<int32>& OutFirst,
+		TArray<int32>& OutTerminals
+	);
+
+	// terminals tested by the last query
+	FORCEINLINE int32 GetNumTested() const
+	{
+		return NumTested;
+	}
+
+private:
+	struct FRow
+	{
+		// first cell and number of cells
+		int32 Offset;
+		int32 Num;
+
+		// in deg.
+		double Width;
+	};
+
+	double Height;
+	TArray<FRow> Rows;
+
+	// in deg., order of Add
+	TArray<double> Latitudes;
+	TArray<double> Longitudes;
+
+	// terminals of cell k are CellTerminals[CellFirst[k]] to CellTerminals[CellFirst[k + 1] - 1],
+	// body-fixed up directions of them in the same order
+	TArray<int32> CellFirst;
+	TArray<int32> CellTerminals;
+	TArray<FVector> CellUps;
+
+	bool Dirty = false;
+
+	int32 NumTested = 0;
+
+	// per satellite, kept between queries
+	TArray<TArray<int32>> Visible;
+	TArray<int32> Tested;
+
+	// sort terminals into cells after Add
+	void Build();
+
+	int32 GetRow(double Latitude) const;
+	int32 GetColumn(int32 Row, double Longitude) const;
+};
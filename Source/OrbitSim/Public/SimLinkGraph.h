@@ -0,0 +1,99 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// in m / s
+constexpr double SpeedOfLight = 299792458.;
+
+// positions a link graph is built from, gathered on the game thread
+struct FSimLinkInput
+{
+	// simulation time (s) of the positions
+	double Time = 0;
+
+	// satellites first, then ground stations (m)
+	TArray<FVector> Nodes;
+	int32 NumSatellites = 0;
+
+	// of nodes (m / s)
+	TArray<double> Speeds;
+
+	// celestial bodies that block links
+	TArray<FVector> Occluders;
+
+	// in m
+	TArray<double> OccluderRadii;
+
+	// in m / s
+	TArray<double> OccluderSpeeds;
+
+	// longest link (m), 0 for no limit
+	double MaxDistance = 0;
+};
+
+// Line of sight links between satellites and ground stations at one time
+// with shortest latency routes from every station, a snapshot
+// FSimLinkTracker and FSimRouter hand to readers on other threads.
+// Links are kept once, by their lower node, in compressed rows, memory
+// grows with the number of links. A graph no reader holds any more can be
+// assigned again without allocating.
+class ORBITSIM_API FSimLinkGraph
+{
+public:
+	// nodes of Input and links between them, lower node first
+	void Assign(const FSimLinkInput& Input, const TArray<FIntPoint>& iLinks);
+
+	FORCEINLINE int32 Num() const
+	{
+		return Nodes.Num();
+	}
+
+	FORCEINLINE int32 GetNumSatellites() const
+	{
+		return NumSatellites;
+	}
+
+	FORCEINLINE const FVector& GetPosition(int32 Node) const
+	{
+		return Nodes[Node];
+	}
+
+	FORCEINLINE int32 GetNumLinks() const
+	{
+		return Targets.Num();
+	}
+
+	// higher nodes linked to Node
+	FORCEINLINE TArrayView<const int32> GetLinks(int32 Node) const
+	{
+		return TArrayView<const int32>(Targets.GetData() + First[Node], First[Node + 1] - First[Node]);
+	}
+
+	// ground stations are the nodes after satellites
+	FORCEINLINE int32 GetNumStations() const
+	{
+		return Nodes.Num() - NumSatellites;
+	}
+
+	// [Station * Num() + Node] previous node on the route from a station,
+	// INDEX_NONE for the station itself and unreachable nodes
+	void SetRoutes(const TArray<int32>& iParents);
+
+	// one way propagation latency (s) of the route from a station, negative without one
+	double GetLatency(int32 Station, int32 Node) const;
+
+	// nodes of the route from a station to Node, empty without one
+	void GetPath(int32 Station, int32 Node, TArray<int32>& OutPath) const;
+
+private:
+	TArray<FVector> Nodes;
+	int32 NumSatellites = 0;
+
+	// links of node i are Targets[First[i]] to Targets[First[i + 1] - 1]
+	TArray<int32> First;
+	TArray<int32> Targets;
+
+	TArray<int32> Parents;
+};
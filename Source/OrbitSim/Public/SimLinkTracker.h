@@ -0,0 +1,132 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimLinkGraph.h"
+#include "SimOcclusionKernel.h"
+
+// Line of sight links kept up to date over successive inputs of the same
+// nodes. Every test a link depends on has a margin: occluder clearance,
+// elevation above the 5 deg. mask at ground ends and range. Margins change
+// no faster than nodes and occluders move, so a pair is tested again only
+// once its margin could have run out. Pairs wait for that in a queue.
+// With MaxDistance candidate pairs come from a uniform grid over
+// MaxDistance plus how far nodes may close in until ListHorizon.
+// Time may run either way, margins are spent by simulation time elapsed
+// in both directions.
+// One thread updates a tracker at a time.
+class ORBITSIM_API FSimLinkTracker
+{
+public:
+	// simulation time (s) candidate pairs are kept and a pair waits at most
+	double ListHorizon = 60;
+
+	// occlusion of due pairs with AVX2 / AVX-512 when CPU supports it
+	bool VectorizedOcclusion = true;
+
+	// positions of the same nodes at a later time, returns
+	// true when links changed or all pairs were tested again,
+	// iInput gets the previous input so its memory is reused
+	bool Update(FSimLinkInput& iInput);
+
+	// links at the last input
+	void CopyLinks(FSimLinkGraph& Graph) const;
+
+	// pairs tested by the last update
+	FORCEINLINE int32 GetNumTested() const
+	{
+		return NumTested;
+	}
+
+	FORCEINLINE const FSimLinkInput& GetInput() const
+	{
+		return Input;
+	}
+
+	FORCEINLINE const TArray<FIntPoint>& GetLinks() const
+	{
+		return Links;
+	}
+
+	// the last update tested all pairs again, links did not come from the previous ones
+	FORCEINLINE bool WasRebuilt() const
+	{
+		return Rebuilt;
+	}
+
+	// links that rose and set in the last update
+	FORCEINLINE const TArray<FIntPoint>& GetRisen() const
+	{
+		return Risen;
+	}
+
+	FORCEINLINE const TArray<FIntPoint>& GetSet() const
+	{
+		return Set;
+	}
+
+private:
+	FSimLinkInput Input;
+
+	// candidate pairs, lower node first
+	TArray<FIntPoint> Pairs;
+	TArray<bool> Linked;
+
+	// linked pairs
+	TArray<FIntPoint> Links;
+
+	bool Rebuilt = false;
+	TArray<FIntPoint> Risen;
+	TArray<FIntPoint> Set;
+
+	struct FEvent
+	{
+		// elapsed time (s) the pair may change at
+		double Time;
+		int32 Pair;
+
+		FORCEINLINE bool operator<(const FEvent& Other) const
+		{
+			return Time < Other.Time;
+		}
+	};
+
+	// heap with the earliest event on top
+	TArray<FEvent> Events;
+
+	// simulation time (s) passed either way since candidate pairs were found
+	double Elapsed = 0;
+
+	int32 NumTested = 0;
+
+	// pairs due in an update, tested in batches so
+	// scratch does not grow with all pairs of a rebuild
+	TArray<int32> Due;
+	TArray<double> DueSafe;
+	TArray<bool> DueLinked;
+
+	// occlusion of due pairs, ends in columns and clear bits
+	TArray<FSimOccluder> Shells;
+	TArray<double> DueAX, DueAY, DueAZ;
+	TArray<double> DueBX, DueBY, DueBZ;
+	TArray<uint64> DueClear;
+
+	// grid broadphase
+	TArray<FIntVector> NodeCells;
+	TArray<int32> CellNodes;
+	TMap<FIntVector, FInt32Vector2> Cells;
+
+	// nodes changed or moved faster than their speeds
+	bool NeedsRebuild(const FSimLinkInput& NewInput) const;
+
+	// pairs closer than Radius, all pairs for 0
+	void FindCandidates(double Radius);
+
+	// test a batch of due pairs, update links and push their events
+	void TestDue(const int32* Batch, int32 Num, bool Rebuild, bool& Changed);
+
+	// state of a pair at Input with Clear line of sight past
+	// occluders and the time (s) it holds for at least
+	bool Evaluate(int32 Pair, bool Clear, double& OutSafe) const;
+};
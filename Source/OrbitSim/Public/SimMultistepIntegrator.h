@@ -0,0 +1,51 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimStateStore.h"
+
+// Adams-Bashforth-Moulton predictor-corrector of order 8 with fixed step.
+// Velocities and accelerations of the last Order steps are kept per body,
+// so a step needs one or two force evaluations instead of four of RK4.
+// The caller starts it with Order - 1 RK4 steps and evaluates forces,
+// methods work on ranges of store indices and may run in parallel.
+class ORBITSIM_API FSimMultistepIntegrator
+{
+public:
+	static constexpr int32 Order = 8;
+
+	// drop history, the step length may change after this only
+	void Reset(int32 NumBodies);
+
+	// enough history for predictor-corrector steps
+	FORCEINLINE bool IsStarted() const
+	{
+		return NumHistory >= Order;
+	}
+
+	// predicted positions and velocities to Store.P[0] and Store.V[0]
+	void Predict(FSimStateStore& Store, double StepLength, int32 Begin, int32 End) const;
+
+	// corrected Store.Position and Store.Velocity from the prediction
+	// and its accelerations in Store.A[0]
+	void Correct(FSimStateStore& Store, double StepLength, int32 Begin, int32 End) const;
+
+	// write Store.Velocity and accelerations Store.A[0] as the next
+	// history point, Commit makes it the newest one
+	void Push(const FSimStateStore& Store, int32 Begin, int32 End);
+	void Commit();
+
+private:
+	// ring of history points, [Newest] is the last one
+	FSimVectorColumn VHistory[Order];
+	FSimVectorColumn AHistory[Order];
+
+	int32 Newest = 0;
+	int32 NumHistory = 0;
+
+	FORCEINLINE int32 Past(int32 Steps) const
+	{
+		return (Newest - Steps + Order) % Order;
+	}
+};
@@ -0,0 +1,66 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// celestial body as seen by occlusion kernels
+struct FSimOccluder
+{
+	// in m
+	double X = 0;
+	double Y = 0;
+	double Z = 0;
+
+	// squared radius (m^2) of the shell 1% above the surface
+	double Shell2 = 0;
+};
+
+// Line of sight of segments between nodes past celestial bodies.
+// A segment is blocked when it passes through the shell of an occluder
+// or, when an end is inside the shell, sees the other end below 5 deg.
+// of elevation. Segments are addressed by index range [Begin, End) in
+// endpoint columns, bit i % 64 of word i / 64 of the result is set when
+// segment i is clear. Begin is a multiple of 64, so tasks with disjoint
+// ranges write disjoint words.
+struct ORBITSIM_API FSimOcclusionKernel
+{
+	static FSimOccluder MakeOccluder
+	(
+		const FVector& Position,
+		double Radius // m
+	);
+
+	// one segment against one occluder
+	static bool IsOccluded
+	(
+		const FSimOccluder& Occluder,
+		const FVector& First,
+		const FVector& Second
+	);
+
+	// widest instruction set supported by this CPU
+	static void Test
+	(
+		const TArray<FSimOccluder>& Occluders,
+		const double* AX, const double* AY, const double* AZ,
+		const double* BX, const double* BY, const double* BZ,
+		int32 Begin,
+		int32 End,
+		uint64* OutClear
+	);
+
+	// reference implementation
+	static void TestScalar
+	(
+		const TArray<FSimOccluder>& Occluders,
+		const double* AX, const double* AY, const double* AZ,
+		const double* BX, const double* BY, const double* BZ,
+		int32 Begin,
+		int32 End,
+		uint64* OutClear
+	);
+
+	// name of the instruction set used by Test
+	static const TCHAR* GetInstructionSet();
+};
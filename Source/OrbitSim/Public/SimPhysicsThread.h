@@ -0,0 +1,84 @@
+// DHmelevcev 2025
+
+#pragma once
+
+class ASimGameMode;
+class FRunnableThread;
+class FEvent;
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "SimSnapshot.h"
+#include "SimSpscRing.h"
+#include <atomic>
+
+// Integrates the state of ASimGameMode ahead of render time and publishes
+// snapshots of it. While the thread runs it owns ASimGameMode::Engine,
+// the game thread may touch it only while it is paused.
+class ORBITSIM_API FSimPhysicsThread : public FRunnable
+{
+public:
+	// starts paused, without bThreaded the state is advanced inline by Pump
+	FSimPhysicsThread(ASimGameMode* iGameMode, bool bThreaded);
+
+	virtual ~FSimPhysicsThread() override;
+
+	// game thread
+
+	// integrate up to Target, publish a snapshot at least every PublishInterval
+	void SetTarget(const FDateTime& Target, const FTimespan& PublishInterval);
+
+	// returns when the state is no longer accessed by the physics thread
+	void Pause();
+
+	// continue integration in Direction of time, -1, 0 or 1
+	void Resume(int32 Direction);
+
+	// integrate toward the target on the calling thread when not threaded,
+	// returns after BudgetSeconds even if the target is not reached
+	void Pump(double BudgetSeconds);
+
+	FORCEINLINE bool IsPaused() const
+	{
+		return bPaused;
+	}
+
+	// write the current state to Snapshots, physics thread
+	// or game thread while paused
+	void Publish();
+
+	// produced by the physics thread, consumed by the game thread
+	TSimSpscRing<FSimSnapshot> Snapshots;
+
+	// FRunnable
+
+	virtual uint32 Run() override;
+
+	virtual void Stop() override;
+
+private:
+	ASimGameMode* GameMode;
+
+	FRunnableThread* Thread = nullptr;
+
+	FEvent* PausedEvent = nullptr;
+	FEvent* ResumeEvent = nullptr;
+
+	std::atomic<bool> bPauseRequested{ true };
+	std::atomic<bool> bStopRequested{ false };
+
+	std::atomic<int64> TargetTicks{ 0 };
+	std::atomic<int64> PublishTicks{ 0 };
+	std::atomic<int32> Direction{ 0 };
+
+	// game thread side of the pause handshake
+	bool bPaused = false;
+
+	// physics thread, or game thread while paused
+	int32 PendingSteps = 0;
+	FDateTime LastPublished;
+
+private:
+	// one step toward the target, false when there is nothing to do
+	bool Advance();
+};
@@ -0,0 +1,81 @@
+// DHmelevcev 2025
+
+#pragma once
+
+class FSimLinkGraph;
+class FSimLinkTracker;
+
+#include "CoreMinimal.h"
+
+// Shortest propagation latency routes from every ground station to all
+// other nodes over the links of an FSimLinkTracker, one tree per station.
+// Trees follow links as they rise and set: a set link cuts the subtree
+// below it, which attaches again through its neighbours, and a risen link
+// relaxes the nodes it may bring closer. Link lengths drift as nodes move,
+// so trees are built from scratch again every RefreshInterval.
+// Memory of neighbour lists and of the search is kept between updates.
+// One thread updates a router at a time.
+class ORBITSIM_API FSimRouter
+{
+public:
+	// simulation time (s) between full rebuilds of trees
+	double RefreshInterval = 10;
+
+	// follow the last update of Tracker
+	void Update(const FSimLinkTracker& Tracker);
+
+	// routes of all stations to Graph of the same nodes
+	void CopyRoutes(FSimLinkGraph& Graph) const;
+
+private:
+	int32 NumNodes = 0;
+	int32 NumSatellites = 0;
+
+	// nodes linked to each node
+	TArray<TArray<int32>> Neighbours;
+
+	// [Station * NumNodes + Node] latency (s) and previous node of routes
+	TArray<double> Latencies;
+	TArray<int32> Parents;
+
+	bool Valid = false;
+
+	// simulation time (s) of the last full rebuild
+	double RefreshTime = 0;
+
+	struct FQueued
+	{
+		double Latency;
+		int32 Node;
+	};
+
+	// memory of one worker task
+	struct FScratch
+	{
+		TArray<FQueued> Queue;
+		TArray<int32> Cut;
+		TArray<int32> First;
+		TArray<int32> Children;
+		TArray<int32> Detached;
+	};
+
+	TArray<FScratch> Scratch;
+
+	// stations split between Scratch.Num() worker tasks
+	template <typename FunctionType>
+	void ForEachStation(int32 NumStations, const FunctionType& Function);
+
+	void BuildTree(int32 Station, const TArray<FVector>& Nodes, FScratch& Memory);
+
+	void RepairTree
+	(
+		int32 Station,
+		const TArray<FVector>& Nodes,
+		const TArray<FIntPoint>& Risen,
+		const TArray<FIntPoint>& Set,
+		FScratch& Memory
+	);
+
+	// Dijkstra from queued nodes of a tree
+	void Relax(int32 Station, const TArray<FVector>& Nodes, TArray<FQueued>& Queue);
+};
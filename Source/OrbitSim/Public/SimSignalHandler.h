@@ -8,6 +8,10 @@ class ASimBaseStation;
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Async/Future.h"
+#include "SimLinkTracker.h"
+#include "SimRouter.h"
+#include "SimGroundTerminals.h"
 #include "SimSignalHandler.generated.h"
 
 UCLASS()
@@ -18,23 +22,111 @@ class ORBITSIM_API ASimSignalHandler : public AActor
 public:
 	ASimSignalHandler();
 
+public:
+	// longest link (km) between satellites or to base stations, only pairs
+	// this close are kept, 0 keeps all pairs and memory grows with their square,
+	// the default suits LEO constellations, raise it for MEO and GEO
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Signal", meta = (ClampMin = "0"))
+	double MaxLinkDistance = 5000;
+
+	// simulation time (s) routes follow rising and setting links
+	// before they are searched again as link lengths drift
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Signal", meta = (ClampMin = "0"))
+	double RouteRefreshInterval = 10;
+
+	// use AVX2 / AVX-512 occlusion kernel when CPU supports it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OrbitSim|Signal")
+	bool VectorizedOcclusion = true;
+
 private:
 	// signal lines currently drawn
 	ULineBatchComponent* LineBatchComponent;
 
-	TArray<double> Distances;
+	// last complete graph and the one being built off the game thread
+	TSharedPtr<const FSimLinkGraph, ESPMode::ThreadSafe> LinkGraph;
+	TFuture<TSharedPtr<const FSimLinkGraph, ESPMode::ThreadSafe>> PendingLinkGraph;
+
+	// updated by one pending graph task at a time
+	TSharedPtr<FSimLinkTracker, ESPMode::ThreadSafe> LinkTracker;
+	TSharedPtr<FSimRouter, ESPMode::ThreadSafe> Router;
+
+	// gathered while no graph task is pending, swapped with the
+	// previous input of the tracker so memory is reused
+	TSharedPtr<FSimLinkInput, ESPMode::ThreadSafe> LinkInput;
+
+	// a previous graph nobody else held, assigned again by the next task
+	TSharedPtr<FSimLinkGraph, ESPMode::ThreadSafe> SpareLinkGraph;
+
+	// actors of nodes of LinkGraph and of the pending one
+	TArray<TWeakObjectPtr<AActor>> GraphNodes;
+	TArray<TWeakObjectPtr<AActor>> PendingNodes;
+
+	// ground points of the first celestial body, far more than base stations
+	FSimGroundTerminals Terminals;
+
+	// physic bodies relative to the body of terminals and
+	// terminals seen by each of them at LinesTime
+	TArray<FVector> TerminalQuery;
+	TArray<int32> VisibleFirst;
+	TArray<int32> VisibleTerminals;
+
+	// lines are redrawn when a graph arrives or bodies move
+	bool LinesDirty = true;
+	FDateTime LinesTime;
 
 	TArray<ASimBody*>* PhysicBodies = nullptr;
 	TArray<ASimCelestialBody*>* CelestialBodies = nullptr;
 	TArray<ASimBaseStation*>* BaseStations = nullptr;
+	const FDateTime* WorldTime = nullptr;
 
 public:
 	virtual void Tick(float DeltaTime) override;
 
 	void SetContext(TArray<ASimBody*>& PhysicBodies,
 		            TArray<ASimCelestialBody*>& CelestialBodies,
-		            TArray<ASimBaseStation*>& BaseStations);
+		            TArray<ASimBaseStation*>& BaseStations,
+		            const FDateTime& WorldTime);
+
+	// links between physic bodies followed by base stations,
+	// a frame or more behind, may be null before the first one
+	FORCEINLINE TSharedPtr<const FSimLinkGraph, ESPMode::ThreadSafe> GetLinkGraph() const
+	{
+		return LinkGraph;
+	}
+
+	// one way propagation latency (s) of the shortest route from a base
+	// station to a body or another station, negative without a route
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Signal")
+	double GetLatency(const ASimBaseStation* From, const AActor* To) const;
+
+	// bodies and stations of the shortest route, From and To included,
+	// empty without a route
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Signal")
+	TArray<AActor*> GetRoute(const ASimBaseStation* From, const AActor* To) const;
+
+	// lightweight ground point on the first celestial body (deg.),
+	// returns its index
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Signal")
+	int32 AddGroundTerminal(double Latitude, double Longitude);
+
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Signal")
+	void ClearGroundTerminals();
+
+	// indices of terminals that see the body above 5 deg. elevation
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Signal")
+	TArray<int32> GetVisibleTerminals(const ASimBody* Body) const;
+
+	// terminal and body pairs in sight of each other
+	UFUNCTION(BlueprintCallable, Category = "OrbitSim|Signal")
+	int32 GetNumVisibleTerminals() const;
 
 private:
-	bool HasCollisions(const FVector& firstPos, const FVector& secondPos);
+	// positions of the current frame for the next graph
+	void GatherLinkInput(FSimLinkInput& Input);
+
+	// visible terminals of the current frame
+	void FindVisibleTerminals();
+
+	// in LinkGraph, INDEX_NONE when the actor is not a node of it
+	int32 FindNode(const AActor* Actor) const;
 };
@@ -0,0 +1,42 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimStateStore.h"
+
+// Positions and velocities of all bodies at one moment of simulation time,
+// in FSimStateStore order. Published by the physics thread and read
+// by the game thread, a snapshot is not modified after publication.
+struct ORBITSIM_API FSimSnapshot
+{
+	FDateTime Time;
+
+	// integration steps of dt since the previous snapshot
+	int32 Steps = 0;
+
+	// in m
+	FSimVectorColumn Position;
+
+	// in m / s
+	FSimVectorColumn Velocity;
+
+public:
+	// copy positions and velocities of State, reuses allocated memory
+	void Write(const FSimStateStore& State, const FDateTime& iTime, int32 iSteps);
+
+	// copy positions and velocities back to State of the same bodies
+	void Read(FSimStateStore& State) const;
+
+	// cubic Hermite interpolation of body Index between A at Alpha = 0
+	// and B at Alpha = 1
+	static void Interpolate
+	(
+		const FSimSnapshot& A,
+		const FSimSnapshot& B,
+		double Alpha,
+		int32 Index,
+		FVector& OutPosition,
+		FVector& OutVelocity
+	);
+};
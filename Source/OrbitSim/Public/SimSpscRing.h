@@ -0,0 +1,82 @@
+// DHmelevcev 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Bounded lock-free queue between one producer and one consumer thread.
+// Elements live in preallocated slots that are reused: the producer fills
+// a slot in place and publishes it, the consumer reads it in place until Pop,
+// so a slot the consumer still holds is never overwritten.
+template <typename ElementType>
+class TSimSpscRing
+{
+public:
+	explicit TSimSpscRing(int32 Capacity = 16)
+	{
+		Slots.SetNum(FMath::RoundUpToPowerOfTwo(FMath::Max(Capacity, 2)));
+		Mask = Slots.Num() - 1;
+	}
+
+	// producer: free slot to fill, nullptr when the ring is full
+	ElementType* BeginWrite()
+	{
+		const uint32 H = Head.load(std::memory_order_relaxed);
+
+		if (H - Tail.load(std::memory_order_acquire) > Mask)
+			return nullptr;
+
+		return &Slots[H & Mask];
+	}
+
+	// producer: publish the slot returned by BeginWrite
+	void EndWrite()
+	{
+		Head.store(Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	bool IsFull() const
+	{
+		return Head.load(std::memory_order_relaxed) - Tail.load(std::memory_order_acquire) > Mask;
+	}
+
+	// consumer: Offset-th unread element, nullptr if it is not published yet
+	const ElementType* Peek(int32 Offset = 0) const
+	{
+		const uint32 T = Tail.load(std::memory_order_relaxed);
+
+		if (Head.load(std::memory_order_acquire) - T <= static_cast<uint32>(Offset))
+			return nullptr;
+
+		return &Slots[(T + Offset) & Mask];
+	}
+
+	// consumer: release the oldest element
+	void Pop()
+	{
+		Tail.store(Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	int32 Num() const
+	{
+		return Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire);
+	}
+
+	// drop all elements, neither thread may use the ring meanwhile
+	void Reset()
+	{
+		Head.store(0, std::memory_order_relaxed);
+		Tail.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	TArray<ElementType> Slots;
+	uint32 Mask = 0;
+
+	// written by the producer
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head{ 0 };
+
+	// written by the consumer
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail{ 0 };
+};
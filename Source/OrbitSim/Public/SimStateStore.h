@@ -0,0 +1,99 @@
+// DHmelevcev 2025
+
+#pragma once
+
+class ASimBody;
+class ASimCelestialBody;
+
+#include "CoreMinimal.h"
+
+// X, Y and Z components of a vector quantity stored in separate arrays
+struct ORBITSIM_API FSimVectorColumn
+{
+	TArray<double> X;
+	TArray<double> Y;
+	TArray<double> Z;
+
+	void SetNum(int32 Num);
+
+	FORCEINLINE FVector Get(int32 Index) const
+	{
+		return FVector(X[Index], Y[Index], Z[Index]);
+	}
+
+	FORCEINLINE void Set(int32 Index, const FVector& Value)
+	{
+		X[Index] = Value.X;
+		Y[Index] = Value.Y;
+		Z[Index] = Value.Z;
+	}
+};
+
+// Contiguous state of all simulated bodies.
+// Celestial bodies occupy indices [0, NumCelestial), physic bodies follow
+// in the order of ASimGameMode::PhysicBodies. Index 0 is the origin.
+// The last NumAnalytic physic bodies are not integrated numerically.
+struct ORBITSIM_API FSimStateStore
+{
+	int32 NumCelestial = 0;
+	int32 NumPhysic = 0;
+	int32 NumAnalytic = 0;
+
+	// in m
+	FSimVectorColumn Position;
+
+	// in m / s
+	FSimVectorColumn Velocity;
+
+	// position buffer
+	FSimVectorColumn P[4];
+
+	// velocity buffer
+	FSimVectorColumn V[4];
+
+	// acceleration buffer
+	// in m / s^2
+	FSimVectorColumn A[4];
+
+	// celestial bodies only
+
+	// Standard gravitational parameter (m^3 / s^2)
+	TArray<double> GM;
+
+	// J2 Perturbation
+	TArray<double> J2;
+
+	// in km
+	TArray<double> Radius;
+
+	// sidereal rotation period (s), 0 for bodies that do not rotate
+	TArray<double> RotationPeriod;
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return NumCelestial + NumPhysic + NumAnalytic;
+	}
+
+	// resize all arrays, contents are undefined
+	void SetNum(int32 iNumCelestial, int32 iNumPhysic, int32 iNumAnalytic = 0);
+
+	// copy positions, velocities and celestial parameters from actors,
+	// last iNumAnalytic of PhysicBodies are propagated analytically
+	void Gather(const TArray<ASimCelestialBody*>& CelestialBodies,
+	            const TArray<ASimBody*>& PhysicBodies,
+	            int32 iNumAnalytic = 0);
+
+	// become a store of celestial bodies of State only
+	void CopyCelestial(const FSimStateStore& State);
+
+	// mirror positions and velocities back to actors for rendering
+	void Scatter(const TArray<ASimCelestialBody*>& CelestialBodies,
+	             const TArray<ASimBody*>& PhysicBodies) const;
+
+	// Position and Velocity to buffers of all stages, zero accelerations
+	void ClearBuffers();
+
+	// the same for one stage
+	void ClearBuffer(int32 Stage);
+};